@@ -0,0 +1,250 @@
+/*
+ * Benchmarks for content loading and id lookup.
+ */
+
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "benchmark.h"
+#include "content.h"
+#include "dataset.h"
+#include "memory_tracker.h"
+
+namespace {
+
+void BM_LoadItems(bench::State &state) {
+    const bench::Dataset &ds = bench::dataset(state.size());
+    for (auto _ : state) {
+        bench::do_not_optimize(load_items(ds.items_path));
+    }
+    state.set_items_processed(state.iterations() * ds.size);
+}
+BENCHMARK(BM_LoadItems);
+
+void BM_LoadRecipes(bench::State &state) {
+    const bench::Dataset &ds = bench::dataset(state.size());
+    for (auto _ : state) {
+        bench::do_not_optimize(load_recipes(ds.recipes_path));
+    }
+    state.set_items_processed(state.iterations() * ds.size);
+}
+BENCHMARK(BM_LoadRecipes);
+
+void BM_LoadMonsters(bench::State &state) {
+    const bench::Dataset &ds = bench::dataset(state.size());
+    for (auto _ : state) {
+        bench::do_not_optimize(load_monsters(ds.monsters_path));
+    }
+    state.set_items_processed(state.iterations() * ds.size);
+}
+BENCHMARK(BM_LoadMonsters);
+
+/**
+ * Startup cost of loading all three content types, with the heap
+ * allocations and bytes retained by one load reported as counters.
+ */
+void BM_LoadAll(bench::State &state) {
+    const bench::Dataset &ds = bench::dataset(state.size());
+    memory::TagStats before = memory::stats(memory::Tag::content);
+    size_t retained = 0;
+    for (auto _ : state) {
+        ItemTable items = load_items(ds.items_path);
+        RecipeTable recipes = load_recipes(ds.recipes_path);
+        MonsterTable monsters = load_monsters(ds.monsters_path);
+        retained = footprint(items).total() + footprint(recipes).total() + footprint(monsters).total();
+        bench::do_not_optimize(items);
+    }
+    memory::TagStats after = memory::stats(memory::Tag::content);
+    state.set_items_processed(state.iterations() * ds.size * 3);
+    state.set_counter("allocs_per_load",
+                      static_cast<double>(after.allocations - before.allocations) / state.iterations());
+    state.set_counter("retained_kib", retained / 1024.0);
+    state.set_counter("rss_mib", memory::process_memory().rss_bytes / (1024.0 * 1024.0));
+}
+BENCHMARK(BM_LoadAll);
+
+/** Ids to look up, drawn uniformly from the dataset. */
+std::vector<std::string> lookup_keys(const std::string &prefix, size_t size) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> pick(0, size - 1);
+    std::vector<std::string> keys(1024);
+    for (auto &key : keys) {
+        key = prefix + std::to_string(pick(rng));
+    }
+    return keys;
+}
+
+void BM_FindItem(bench::State &state) {
+    const bench::Dataset &ds = bench::dataset(state.size());
+    std::vector<std::string> keys = lookup_keys("item_", ds.size);
+    size_t i = 0;
+    for (auto _ : state) {
+        bench::do_not_optimize(find_item(ds.items, keys[i++ & 1023]));
+    }
+    state.set_items_processed(state.iterations());
+}
+BENCHMARK(BM_FindItem);
+
+void BM_FindMonster(bench::State &state) {
+    const bench::Dataset &ds = bench::dataset(state.size());
+    std::vector<std::string> keys = lookup_keys("mon_", ds.size);
+    size_t i = 0;
+    for (auto _ : state) {
+        bench::do_not_optimize(find_monster(ds.monsters, keys[i++ & 1023]));
+    }
+    state.set_items_processed(state.iterations());
+}
+BENCHMARK(BM_FindMonster);
+
+void BM_FindItemScan(bench::State &state) {
+    // Linear scan comparing cached hashes; keys are hashed up front.
+    const bench::Dataset &ds = bench::dataset(state.size());
+    std::vector<std::string> keys = lookup_keys("item_", ds.size);
+    std::vector<Id> ids(keys.begin(), keys.end());
+    size_t i = 0;
+    for (auto _ : state) {
+        bench::do_not_optimize(find_item(Span<const Item>(ds.items), ids[i++ & 1023]));
+    }
+    state.set_items_processed(state.iterations());
+}
+BENCHMARK(BM_FindItemScan);
+
+// Hash map lookups keyed by std::string versus Id, with keys built
+// before the loop as a registry would receive them.
+
+void BM_StringMapLookup(bench::State &state) {
+    const bench::Dataset &ds = bench::dataset(state.size());
+    std::unordered_map<std::string, const Item *> registry;
+    for (const Item &item : ds.items) {
+        registry.emplace(std::string(item.id.view()), &item);
+    }
+    std::vector<std::string> keys = lookup_keys("item_", ds.size);
+    size_t i = 0;
+    for (auto _ : state) {
+        bench::do_not_optimize(registry.find(keys[i++ & 1023]));
+    }
+    state.set_items_processed(state.iterations());
+}
+BENCHMARK(BM_StringMapLookup);
+
+void BM_IdMapLookup(bench::State &state) {
+    const bench::Dataset &ds = bench::dataset(state.size());
+    std::unordered_map<Id, const Item *> registry;
+    for (const Item &item : ds.items) {
+        registry.emplace(item.id, &item);
+    }
+    std::vector<std::string> keys = lookup_keys("item_", ds.size);
+    std::vector<Id> ids(keys.begin(), keys.end());
+    size_t i = 0;
+    for (auto _ : state) {
+        bench::do_not_optimize(registry.find(ids[i++ & 1023]));
+    }
+    state.set_items_processed(state.iterations());
+}
+BENCHMARK(BM_IdMapLookup);
+
+void BM_IdTableLookup(bench::State &state) {
+    const bench::Dataset &ds = bench::dataset(state.size());
+    std::vector<std::string> keys = lookup_keys("item_", ds.size);
+    std::vector<Id> ids(keys.begin(), keys.end());
+    size_t i = 0;
+    for (auto _ : state) {
+        bench::do_not_optimize(ds.items.find(ids[i++ & 1023]));
+    }
+    state.set_items_processed(state.iterations());
+}
+BENCHMARK(BM_IdTableLookup);
+
+// Whole-table material queries: bitsets resolved at load time versus
+// the per-item lists of material names they replace.
+
+/** Material names of every item, as the loader used to keep them. */
+std::vector<std::vector<std::string>> material_lists(const ItemTable &items) {
+    std::vector<std::vector<std::string>> lists;
+    lists.reserve(items.size());
+    for (const Item &item : items) {
+        std::vector<std::string> names;
+        item.materials.for_each([&](size_t id) { names.push_back(material_names().name(static_cast<uint32_t>(id))); });
+        lists.push_back(std::move(names));
+    }
+    return lists;
+}
+
+void BM_MaterialAnyBitset(bench::State &state) {
+    // Items made of steel or iron.
+    const bench::Dataset &ds = bench::dataset(state.size());
+    MaterialSet mask;
+    mask.set(material_names().find("steel"));
+    mask.set(material_names().find("iron"));
+    std::vector<uint32_t> out;
+    for (auto _ : state) {
+        out.clear();
+        select_any(Span<const Item>(ds.items), [](const Item &item) -> const MaterialSet & { return item.materials; },
+                   mask, out);
+        bench::do_not_optimize(out.data());
+    }
+    state.set_items_processed(state.iterations() * ds.items.size());
+}
+BENCHMARK(BM_MaterialAnyBitset);
+
+void BM_MaterialAnyStrings(bench::State &state) {
+    const bench::Dataset &ds = bench::dataset(state.size());
+    std::vector<std::vector<std::string>> lists = material_lists(ds.items);
+    std::vector<uint32_t> out;
+    for (auto _ : state) {
+        out.clear();
+        for (size_t i = 0; i < lists.size(); ++i) {
+            for (const std::string &name : lists[i]) {
+                if (name == "steel" || name == "iron") {
+                    out.push_back(static_cast<uint32_t>(i));
+                    break;
+                }
+            }
+        }
+        bench::do_not_optimize(out.data());
+    }
+    state.set_items_processed(state.iterations() * ds.items.size());
+}
+BENCHMARK(BM_MaterialAnyStrings);
+
+void BM_MaterialAllBitset(bench::State &state) {
+    // Items made of both steel and plastic.
+    const bench::Dataset &ds = bench::dataset(state.size());
+    MaterialSet mask;
+    mask.set(material_names().find("steel"));
+    mask.set(material_names().find("plastic"));
+    std::vector<uint32_t> out;
+    for (auto _ : state) {
+        out.clear();
+        select_all(Span<const Item>(ds.items), [](const Item &item) -> const MaterialSet & { return item.materials; },
+                   mask, out);
+        bench::do_not_optimize(out.data());
+    }
+    state.set_items_processed(state.iterations() * ds.items.size());
+}
+BENCHMARK(BM_MaterialAllBitset);
+
+void BM_MaterialAllStrings(bench::State &state) {
+    const bench::Dataset &ds = bench::dataset(state.size());
+    std::vector<std::vector<std::string>> lists = material_lists(ds.items);
+    std::vector<uint32_t> out;
+    for (auto _ : state) {
+        out.clear();
+        for (size_t i = 0; i < lists.size(); ++i) {
+            bool steel = false;
+            bool plastic = false;
+            for (const std::string &name : lists[i]) {
+                steel |= name == "steel";
+                plastic |= name == "plastic";
+            }
+            if (steel && plastic) out.push_back(static_cast<uint32_t>(i));
+        }
+        bench::do_not_optimize(out.data());
+    }
+    state.set_items_processed(state.iterations() * ds.items.size());
+}
+BENCHMARK(BM_MaterialAllStrings);
+
+} // namespace
@@ -0,0 +1,98 @@
+/*
+ * Benchmarks for field simulation: a turn with a large fire burning
+ * against a turn on an idle map, and a per-tile scan of the same map
+ * for comparison.
+ */
+
+#include "benchmark.h"
+#include "field.h"
+#include "frame_allocator.h"
+#include "map.h"
+#include "simulation.h"
+
+namespace {
+
+// A map 32x32 submaps across (147456 tiles), all simulated every turn.
+constexpr int kSide = 32;
+constexpr Point kCenter{kSide / 2, kSide / 2};
+
+void fill(Map &map) {
+    for (int y = 0; y < kSide; ++y) {
+        for (int x = 0; x < kSide; ++x) map.submap(Point{x, y});
+    }
+}
+
+/**
+ * A blaze lit along the whole west edge of the map, which burns east
+ * as a front 384 tiles wide. The map is rebuilt and lit again once the
+ * front has crossed it and died out.
+ */
+void BM_FieldTurnFire(bench::State &state) {
+    Map map;
+    uint64_t turn = 0;
+    size_t last = 0;
+    size_t tiles = 0;
+    auto light = [&]() {
+        map = Map();
+        fill(map);
+        for (int y = 0; y < kSide * kSubmapSize; ++y) {
+            place_field(map, Point{0, y}, FieldType::fire, FieldLayer::kMaxIntensity, turn, 1);
+        }
+        last = kSide * kSubmapSize;
+    };
+    light();
+    for (auto _ : state) {
+        frame::begin_turn();
+        if (last < 100) {
+            state.pause_timing();
+            light();
+            state.resume_timing();
+        }
+        ++turn;
+        last = simulate_turn(map, kCenter, kSide / 2, turn, 1).field_tiles;
+        tiles += last;
+    }
+    state.set_counter("field_tiles_per_turn", static_cast<double>(tiles) / static_cast<double>(state.iterations()));
+    state.set_items_processed(tiles);
+}
+BENCHMARK(BM_FieldTurnFire);
+
+/** The same map with no fields: the turn only visits the submaps. */
+void BM_FieldTurnIdle(bench::State &state) {
+    Map map;
+    fill(map);
+    uint64_t turn = 0;
+    for (auto _ : state) {
+        frame::begin_turn();
+        bench::do_not_optimize(simulate_turn(map, kCenter, kSide / 2, ++turn, 1).submaps);
+    }
+    state.set_items_processed(state.iterations() * kSide * kSide * kSubmapTiles);
+}
+BENCHMARK(BM_FieldTurnIdle);
+
+/**
+ * Baseline: the per-tile pass a dense design makes every turn, with
+ * every submap holding a field layer and every tile checked for
+ * fields, before any spreading or decay is done.
+ */
+void BM_FieldTurnScanAllTiles(bench::State &state) {
+    Map map;
+    fill(map);
+    for (int y = 0; y < kSide; ++y) {
+        for (int x = 0; x < kSide; ++x) map.submap(Point{x, y}).field_layer();
+    }
+    for (auto _ : state) {
+        size_t burning = 0;
+        map.for_each([&](const Submap &sm) {
+            const FieldLayer &fields = *sm.fields();
+            for (int t = 0; t < kSubmapTiles; ++t) {
+                for (int f = 0; f < kFieldTypes; ++f) burning += fields.intensity(t, static_cast<FieldType>(f)) > 0;
+            }
+        });
+        bench::do_not_optimize(burning);
+    }
+    state.set_items_processed(state.iterations() * kSide * kSide * kSubmapTiles);
+}
+BENCHMARK(BM_FieldTurnScanAllTiles);
+
+} // namespace
@@ -0,0 +1,75 @@
+/*
+ * Benchmarks for hordes: moving a thousand hordes a step on the
+ * overmap, against simulating the same monsters one by one on the map.
+ */
+
+#include <memory>
+
+#include "benchmark.h"
+#include "dataset.h"
+#include "horde.h"
+#include "map.h"
+#include "overmap.h"
+#include "simulation.h"
+
+namespace {
+
+constexpr size_t kHordes = 1000;
+constexpr int kMinSize = 20;
+constexpr int kMaxSize = 80;
+// Active area that takes in the whole overmap.
+constexpr int kWholeOvermap = kOvermapSize * kSubmapsPerOmt / 2;
+
+/** Hordes on one overmap, built once and shared by the benchmarks. */
+struct HordeWorld {
+    std::unique_ptr<Overmap> overmap;
+    Hordes hordes;
+    Map map;
+    uint64_t turn = 0;
+};
+
+HordeWorld &horde_world(const bench::Dataset &ds, bool expanded) {
+    static HordeWorld worlds[2];
+    HordeWorld &world = worlds[expanded];
+    if (!world.overmap) {
+        world.overmap = std::make_unique<Overmap>(Point{0, 0}, 5);
+        world.hordes.populate(*world.overmap, *ds.monster_groups.begin(), kHordes, kMinSize, kMaxSize, 7);
+        if (expanded) {
+            Point center{kWholeOvermap, kWholeOvermap};
+            world.hordes.update(world.map, center, kWholeOvermap, world.turn, 1);
+        }
+    }
+    return world;
+}
+
+/** Every horde takes one step on the overmap, far from the player. */
+void BM_HordeStep(bench::State &state) {
+    HordeWorld &world = horde_world(bench::dataset(state.size()), false);
+    const Point away{-100000, -100000};
+    for (auto _ : state) {
+        world.turn += kHordeMoveInterval;
+        bench::do_not_optimize(world.hordes.update(world.map, away, kActiveRadius, world.turn, 1).steps);
+    }
+    state.set_counter("monsters", static_cast<double>(world.hordes.monster_count()));
+    state.set_items_processed(state.iterations() * world.hordes.size());
+}
+BENCHMARK(BM_HordeStep);
+
+/**
+ * Baseline: the same hordes expanded into individual monsters, with one
+ * turn simulated over the whole overmap. A horde step stands for
+ * kHordeMoveInterval of these.
+ */
+void BM_HordeTileLevel(bench::State &state) {
+    HordeWorld &world = horde_world(bench::dataset(state.size()), true);
+    const Point center{kWholeOvermap, kWholeOvermap};
+    for (auto _ : state) {
+        ++world.turn;
+        bench::do_not_optimize(simulate_turn(world.map, center, kWholeOvermap, world.turn, 1).monsters);
+    }
+    state.set_counter("monsters", static_cast<double>(world.map.monster_count()));
+    state.set_items_processed(state.iterations() * world.map.monster_count());
+}
+BENCHMARK(BM_HordeTileLevel);
+
+} // namespace
@@ -0,0 +1,108 @@
+/*
+ * Benchmarks for lighting: moving one light among many with cached
+ * contributions against recasting every light, and summing light grids
+ * with SSE2 against the scalar loop.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "benchmark.h"
+#include "frame_allocator.h"
+#include "lighting.h"
+#include "map.h"
+#include "rng.h"
+
+namespace {
+
+// 32x32 submaps with one tile in ten walled, lit by 2000 lamps of
+// radius 8.
+constexpr int kSide = 32;
+constexpr int kTiles = kSide * kSubmapSize;
+constexpr size_t kLamps = 2000;
+constexpr int kRadius = 8;
+
+struct LitWorld {
+    Map map;
+    Lighting lighting;
+    std::vector<LightId> lamps;
+    std::vector<LightSource> sources;
+};
+
+LitWorld &lit_world() {
+    static LitWorld world;
+    if (world.lamps.empty()) {
+        Rng rng(17);
+        for (int sy = 0; sy < kSide; ++sy) {
+            for (int sx = 0; sx < kSide; ++sx) {
+                Submap &sm = world.map.submap(Point{sx, sy});
+                for (int y = 0; y < kSubmapSize; ++y) {
+                    for (int x = 0; x < kSubmapSize; ++x) sm.set_opaque(x, y, rng.below(10) == 0);
+                }
+            }
+        }
+        for (size_t i = 0; i < kLamps; ++i) {
+            Point pos{static_cast<int>(rng.below(kTiles)), static_cast<int>(rng.below(kTiles))};
+            world.sources.push_back(LightSource{pos, kRadius, 200});
+            world.lamps.push_back(world.lighting.add(world.sources.back()));
+        }
+        world.lighting.update(world.map);
+    }
+    return world;
+}
+
+/** One lamp moves a tile and the light is brought up to date. */
+void BM_LightingMoveOne(bench::State &state) {
+    LitWorld &world = lit_world();
+    Rng rng(19);
+    for (auto _ : state) {
+        frame::begin_turn();
+        size_t i = rng.below(static_cast<uint32_t>(kLamps));
+        Point &pos = world.sources[i].pos;
+        pos.x = std::clamp(pos.x + static_cast<int>(rng.below(3)) - 1, 0, kTiles - 1);
+        pos.y = std::clamp(pos.y + static_cast<int>(rng.below(3)) - 1, 0, kTiles - 1);
+        world.lighting.move(world.lamps[i], pos);
+        bench::do_not_optimize(world.lighting.update(world.map));
+    }
+    state.set_counter("lights", static_cast<double>(world.lighting.size()));
+    state.set_items_processed(state.iterations());
+}
+BENCHMARK(BM_LightingMoveOne);
+
+/** Baseline: every light is cast again and every grid summed again. */
+void BM_LightingRecomputeAll(bench::State &state) {
+    LitWorld &world = lit_world();
+    for (auto _ : state) {
+        frame::begin_turn();
+        Lighting lighting;
+        for (const LightSource &source : world.sources) lighting.add(source);
+        bench::do_not_optimize(lighting.update(world.map));
+    }
+    state.set_counter("lights", static_cast<double>(world.sources.size()));
+    state.set_items_processed(state.iterations());
+}
+BENCHMARK(BM_LightingRecomputeAll);
+
+/** Sum 16 light grids into one, as a submap lit by 16 sources is rebuilt. */
+template <void (*Add)(LightGrid &, const LightGrid &)>
+void sum_grids(bench::State &state) {
+    Rng rng(23);
+    std::vector<LightGrid> grids(16);
+    for (LightGrid &grid : grids) {
+        for (uint8_t &level : grid.level) level = static_cast<uint8_t>(rng.below(64));
+    }
+    LightGrid sum;
+    for (auto _ : state) {
+        sum = LightGrid();
+        for (const LightGrid &grid : grids) Add(sum, grid);
+        bench::do_not_optimize(sum.level.data());
+    }
+    state.set_items_processed(state.iterations() * grids.size() * kSubmapTiles);
+}
+
+void BM_LightSum(bench::State &state) { sum_grids<add_light>(state); }
+void BM_LightSumScalar(bench::State &state) { sum_grids<add_light_scalar>(state); }
+BENCHMARK(BM_LightSum);
+BENCHMARK(BM_LightSumScalar);
+
+} // namespace
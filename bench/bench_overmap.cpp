@@ -0,0 +1,60 @@
+/*
+ * Benchmarks for overmap generation: rows of gradient noise on each
+ * instruction-set path, and whole 180x180 overmaps.
+ */
+
+#include <vector>
+
+#include "benchmark.h"
+#include "noise.h"
+#include "overmap.h"
+
+namespace {
+
+constexpr int kRow = 1024;
+
+/** Noise rows of kRow samples, walking down the map. */
+template <SimdPath Path>
+void noise_rows(bench::State &state) {
+    NoiseParams params;
+    params.seed = 11;
+    std::vector<float> out(kRow);
+    int y = 0;
+    for (auto _ : state) {
+        noise_row(params, 0, y++, kRow, out.data(), Path);
+        bench::do_not_optimize(out.data());
+    }
+    state.set_counter("octaves", params.octaves);
+    state.set_items_processed(state.iterations() * kRow);
+}
+
+void BM_NoiseRowScalar(bench::State &state) { noise_rows<SimdPath::scalar>(state); }
+void BM_NoiseRowSse2(bench::State &state) { noise_rows<SimdPath::sse2>(state); }
+void BM_NoiseRowAvx2(bench::State &state) { noise_rows<SimdPath::avx2>(state); }
+BENCHMARK(BM_NoiseRowScalar);
+BENCHMARK(BM_NoiseRowSse2);
+BENCHMARK(BM_NoiseRowAvx2);
+
+/** A fresh overmap, on the widest path the CPU supports. */
+void BM_OvermapGenerate(bench::State &state) {
+    int x = 0;
+    for (auto _ : state) {
+        Overmap overmap(Point{x++, 0}, 5);
+        bench::do_not_optimize(overmap.count(OvermapTerrain::city));
+    }
+    state.set_items_processed(state.iterations() * kOvermapTiles);
+}
+BENCHMARK(BM_OvermapGenerate);
+
+/** Baseline: the same with the scalar kernel. */
+void BM_OvermapGenerateScalar(bench::State &state) {
+    int x = 0;
+    for (auto _ : state) {
+        Overmap overmap(Point{x++, 0}, 5, SimdPath::scalar);
+        bench::do_not_optimize(overmap.count(OvermapTerrain::city));
+    }
+    state.set_items_processed(state.iterations() * kOvermapTiles);
+}
+BENCHMARK(BM_OvermapGenerateScalar);
+
+} // namespace
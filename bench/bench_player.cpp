@@ -0,0 +1,224 @@
+/*
+ * Benchmarks for inventory handling, crafting checks and combat.
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "benchmark.h"
+#include "combat.h"
+#include "crafting.h"
+#include "dataset.h"
+#include "instances.h"
+#include "player.h"
+
+namespace {
+
+/**
+ * Player carrying one of every item in the dataset. Items are placed
+ * at the top level so that setup stays linear in the dataset size.
+ */
+Player loaded_player(const bench::Dataset &ds) {
+    Player player;
+    for (const Item &item : ds.items) {
+        player.inventory.insert(spawn_item(item));
+    }
+    return player;
+}
+
+/** Return a player's items to the pool. */
+void release_inventory(Player &player) {
+    player.inventory.for_each_item([](Inventory::NodeId, ItemHandle h) {
+        item_pool().destroy(h);
+    });
+    player.inventory.clear();
+}
+
+void BM_InventoryAddRemove(bench::State &state) {
+    const bench::Dataset &ds = bench::dataset(state.size());
+    Player player = loaded_player(ds);
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<size_t> pick(0, ds.items.size() - 1);
+    ItemHandle removed;
+    for (auto _ : state) {
+        // Remove a random item and put it back at the end.
+        const Item &target = ds.items[pick(rng)];
+        player.remove_item(target.id, removed);
+        player.add_item(removed);
+    }
+    release_inventory(player);
+    state.set_items_processed(state.iterations());
+}
+BENCHMARK(BM_InventoryAddRemove);
+
+void BM_CraftCheck(bench::State &state) {
+    const bench::Dataset &ds = bench::dataset(state.size());
+    Player player = loaded_player(ds);
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<size_t> pick(0, ds.recipes.size() - 1);
+    for (auto _ : state) {
+        bench::do_not_optimize(has_components(player, ds.recipes[pick(rng)]));
+    }
+    release_inventory(player);
+    state.set_items_processed(state.iterations());
+}
+BENCHMARK(BM_CraftCheck);
+
+void BM_CapacityCheck(bench::State &state) {
+    // Uses the running totals kept by add_item/remove_item.
+    const bench::Dataset &ds = bench::dataset(state.size());
+    Player player = loaded_player(ds);
+    std::mt19937 rng(17);
+    std::uniform_int_distribution<size_t> pick(0, ds.items.size() - 1);
+    for (auto _ : state) {
+        bench::do_not_optimize(player.can_carry(ds.items[pick(rng)]));
+    }
+    release_inventory(player);
+    state.set_items_processed(state.iterations());
+}
+BENCHMARK(BM_CapacityCheck);
+
+void BM_CapacityCheckRescan(bench::State &state) {
+    // Baseline: total the inventory on every check.
+    const bench::Dataset &ds = bench::dataset(state.size());
+    Player player = loaded_player(ds);
+    std::mt19937 rng(17);
+    std::uniform_int_distribution<size_t> pick(0, ds.items.size() - 1);
+    for (auto _ : state) {
+        const Item &type = ds.items[pick(rng)];
+        int64_t weight = 0;
+        int64_t volume = 0;
+        player.inventory.for_each_item([&](Inventory::NodeId, ItemHandle h) {
+            const Item *carried = item_type(h);
+            weight += carried->weight;
+            volume += carried->volume;
+        });
+        bench::do_not_optimize(weight + type.weight <= Player::kWeightCapacity &&
+                               volume + type.volume <= Player::kVolumeCapacity);
+    }
+    release_inventory(player);
+    state.set_items_processed(state.iterations());
+}
+BENCHMARK(BM_CapacityCheckRescan);
+
+void BM_NestedInsertRemove(bench::State &state) {
+    // A chain of containers eight deep under a large inventory; items
+    // go into and out of the innermost pocket, updating the weight and
+    // count caches of every enclosing node.
+    const bench::Dataset &ds = bench::dataset(state.size());
+    Pocket pocket{1000000, 1000000};
+    Item bag;
+    bag.id = "bench_bag";
+    bag.name = "bag";
+    bag.weight = 100;
+    bag.volume = 1000;
+    bag.pockets = Span<const Pocket>(&pocket, 1);
+    Player player = loaded_player(ds);
+    Inventory &inv = player.inventory;
+    Inventory::NodeId innermost = Inventory::kRoot;
+    for (int depth = 0; depth < 8; ++depth) {
+        innermost = inv.first_child(inv.insert(spawn_item(bag), innermost));
+    }
+    std::mt19937 rng(19);
+    std::uniform_int_distribution<size_t> pick(0, ds.items.size() - 1);
+    std::vector<ItemHandle> contents;
+    for (auto _ : state) {
+        ItemHandle h = spawn_item(ds.items[pick(rng)]);
+        Inventory::NodeId n = inv.insert(h, innermost);
+        bench::do_not_optimize(inv.fits(ds.items[pick(rng)], innermost));
+        inv.remove(n, contents);
+        item_pool().destroy(h);
+    }
+    bench::do_not_optimize(inv.weight(Inventory::kRoot));
+    release_inventory(player);
+    state.set_items_processed(state.iterations());
+}
+BENCHMARK(BM_NestedInsertRemove);
+
+void BM_InventoryFilter(bench::State &state) {
+    // Sorted listing of every steel item through the material index.
+    const bench::Dataset &ds = bench::dataset(state.size());
+    Player player = loaded_player(ds);
+    Id steel("steel");
+    size_t matches = 0;
+    for (auto _ : state) {
+        for (Inventory::NodeId n : player.inventory.with(Inventory::Facet::material, steel)) {
+            bench::do_not_optimize(player.inventory.type(n)->name);
+            ++matches;
+        }
+    }
+    release_inventory(player);
+    state.set_items_processed(matches);
+}
+BENCHMARK(BM_InventoryFilter);
+
+void BM_InventoryFilterScan(bench::State &state) {
+    // Baseline: scan the inventory for steel items and sort them by name.
+    const bench::Dataset &ds = bench::dataset(state.size());
+    Player player = loaded_player(ds);
+    std::vector<const Item *> found;
+    uint32_t steel = material_names().find("steel");
+    size_t matches = 0;
+    for (auto _ : state) {
+        found.clear();
+        player.inventory.for_each_item([&](Inventory::NodeId n, ItemHandle) {
+            const Item *type = player.inventory.type(n);
+            if (type->materials.test(steel)) {
+                found.push_back(type);
+            }
+        });
+        std::sort(found.begin(), found.end(), [](const Item *a, const Item *b) { return a->name < b->name; });
+        for (const Item *type : found) {
+            bench::do_not_optimize(type->name);
+        }
+        matches += found.size();
+    }
+    release_inventory(player);
+    state.set_items_processed(matches);
+}
+BENCHMARK(BM_InventoryFilterScan);
+
+void BM_ItemSpawnDestroy(bench::State &state) {
+    const bench::Dataset &ds = bench::dataset(state.size());
+    // Keep a window of live items so that slots are recycled the way
+    // crafting and spawning recycle them in play.
+    std::vector<ItemHandle> live(1024);
+    for (ItemHandle &h : live) {
+        h = spawn_item(ds.items.front());
+    }
+    size_t next = 0;
+    for (auto _ : state) {
+        ItemHandle &slot = live[next++ % live.size()];
+        item_pool().destroy(slot);
+        slot = spawn_item(ds.items[next % ds.items.size()]);
+    }
+    bench::do_not_optimize(item_type(live.front()));
+    for (ItemHandle h : live) {
+        item_pool().destroy(h);
+    }
+    state.set_items_processed(state.iterations());
+}
+BENCHMARK(BM_ItemSpawnDestroy);
+
+void BM_CombatResolve(bench::State &state) {
+    const bench::Dataset &ds = bench::dataset(state.size());
+    Player armed;
+    armed.add_item(spawn_item(ds.items.front()));
+    std::mt19937 rng(13);
+    std::uniform_int_distribution<size_t> pick(0, ds.monsters.size() - 1);
+    uint64_t rounds = 0;
+    for (auto _ : state) {
+        Player player = armed;
+        MonsterHandle enemy = spawn_monster(ds.monsters[pick(rng)]);
+        CombatResult result = resolve_combat(player, *monster_pool().get(enemy), nullptr);
+        monster_pool().destroy(enemy);
+        rounds += result.rounds;
+    }
+    release_inventory(armed);
+    // Throughput is reported in combat rounds.
+    state.set_items_processed(rounds);
+}
+BENCHMARK(BM_CombatResolve);
+
+} // namespace
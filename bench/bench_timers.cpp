@@ -0,0 +1,74 @@
+/*
+ * Benchmarks for scheduled world events: the timing wheel against a
+ * per-turn scan of every entity's deadline.
+ */
+
+#include <vector>
+
+#include "benchmark.h"
+#include "rng.h"
+#include "timer_wheel.h"
+
+namespace {
+
+// Pending timers: 100 per dataset object, so the default size gives a
+// million.
+size_t timer_count(const bench::State &state) {
+    return state.size() * 100;
+}
+
+// Deadlines are spread over about a day of one-second turns.
+constexpr uint32_t kHorizon = 100000;
+
+void BM_TimerScheduleCancel(bench::State &state) {
+    TimerWheel wheel;
+    Rng rng(3);
+    std::vector<TimerId> ids(timer_count(state));
+    for (TimerId &id : ids) id = wheel.schedule(1 + rng.below(kHorizon), TimerEvent{});
+    for (auto _ : state) {
+        TimerId &id = ids[rng.below(static_cast<uint32_t>(ids.size()))];
+        wheel.cancel(id);
+        id = wheel.schedule(1 + rng.below(kHorizon), TimerEvent{});
+    }
+    state.set_items_processed(state.iterations());
+}
+BENCHMARK(BM_TimerScheduleCancel);
+
+/** One turn with a million pending timers; each fired timer is re-armed. */
+void BM_TimerTurn(bench::State &state) {
+    TimerWheel wheel;
+    Rng rng(5);
+    size_t n = timer_count(state);
+    for (size_t i = 0; i < n; ++i) wheel.schedule(1 + rng.below(kHorizon), TimerEvent{0, i});
+    size_t fired = 0;
+    for (auto _ : state) {
+        fired += wheel.advance(wheel.now() + 1, [&](TimerId, TimerEvent event) {
+            wheel.schedule(wheel.now() + 1 + rng.below(kHorizon), event);
+        });
+    }
+    state.set_counter("pending", static_cast<double>(wheel.size()));
+    state.set_items_processed(fired);
+}
+BENCHMARK(BM_TimerTurn);
+
+/** Baseline: every turn, check every entity's deadline. */
+void BM_TimerTurnScan(bench::State &state) {
+    Rng rng(5);
+    std::vector<uint64_t> deadlines(timer_count(state));
+    for (uint64_t &d : deadlines) d = 1 + rng.below(kHorizon);
+    uint64_t now = 0;
+    size_t fired = 0;
+    for (auto _ : state) {
+        ++now;
+        for (uint64_t &d : deadlines) {
+            if (d <= now) {
+                d = now + 1 + rng.below(kHorizon);
+                ++fired;
+            }
+        }
+    }
+    state.set_items_processed(fired);
+}
+BENCHMARK(BM_TimerTurnScan);
+
+} // namespace
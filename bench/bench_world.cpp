@@ -0,0 +1,250 @@
+/*
+ * Benchmarks for world population (item group sampling, bulk item and
+ * monster spawns), for time-dependent state of world items and for
+ * the cost of a simulated turn as the map grows.
+ */
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "benchmark.h"
+#include "content.h"
+#include "dataset.h"
+#include "frame_allocator.h"
+#include "item_group.h"
+#include "map.h"
+#include "monster_group.h"
+#include "simulation.h"
+
+namespace {
+
+/** The group with the most distinct items after flattening. */
+const ItemGroup &widest_group(const bench::Dataset &ds) {
+    return *std::max_element(ds.item_groups.begin(), ds.item_groups.end(),
+                             [](const ItemGroup &a, const ItemGroup &b) { return a.items.size() < b.items.size(); });
+}
+
+void BM_ItemGroupSample(bench::State &state) {
+    const bench::Dataset &ds = bench::dataset(state.size());
+    const ItemGroup &group = widest_group(ds);
+    Rng rng(7);
+    for (auto _ : state) {
+        bench::do_not_optimize(group.sample(rng));
+    }
+    state.set_counter("entries", static_cast<double>(group.items.size()));
+    state.set_items_processed(state.iterations());
+}
+BENCHMARK(BM_ItemGroupSample);
+
+void BM_ItemGroupSampleLinear(bench::State &state) {
+    // Baseline: walk the cumulative probabilities until they pass a
+    // uniform draw.
+    const bench::Dataset &ds = bench::dataset(state.size());
+    const ItemGroup &group = widest_group(ds);
+    Rng rng(7);
+    for (auto _ : state) {
+        double u = rng.uniform();
+        size_t i = 0;
+        for (double acc = group.probabilities[0]; acc <= u && i + 1 < group.items.size(); ) {
+            acc += group.probabilities[++i];
+        }
+        bench::do_not_optimize(group.items[i]);
+    }
+    state.set_counter("entries", static_cast<double>(group.items.size()));
+    state.set_items_processed(state.iterations());
+}
+BENCHMARK(BM_ItemGroupSampleLinear);
+
+/** Fill 32x32 submaps (147456 tiles) at 5% density in one call. */
+void BM_SpawnRegion(bench::State &state) {
+    const bench::Dataset &ds = bench::dataset(state.size());
+    const ItemGroup &group = widest_group(ds);
+    size_t items = 0;
+    uint64_t seed = 1;
+    for (auto _ : state) {
+        Map map;
+        SpawnStats stats = spawn_item_group(map, group, Point{0, 0}, Point{31, 31}, 0.05, 0, seed++);
+        items += stats.items;
+        state.pause_timing();
+        map.for_each([](const Submap &sm) {
+            for (ItemHandle h : sm.items()) item_pool().destroy(h);
+        });
+        state.resume_timing();
+    }
+    state.set_counter("items_per_call", static_cast<double>(items) / static_cast<double>(state.iterations()));
+    state.set_items_processed(state.iterations() * 32 * 32 * kSubmapTiles);
+}
+BENCHMARK(BM_SpawnRegion);
+
+/**
+ * Place packs over 64x64 new submaps in one batch: half a pack per
+ * submap on average, centres at least 8 tiles apart.
+ */
+void BM_SpawnMonsterRegion(bench::State &state) {
+    const bench::Dataset &ds = bench::dataset(state.size());
+    const MonsterGroup &group = *std::max_element(
+        ds.monster_groups.begin(), ds.monster_groups.end(),
+        [](const MonsterGroup &a, const MonsterGroup &b) { return a.monsters.size() < b.monsters.size(); });
+    MonsterSpawnOptions options;
+    size_t packs = 0;
+    size_t monsters = 0;
+    uint64_t seed = 1;
+    for (auto _ : state) {
+        Map map;
+        MonsterSpawnStats stats = spawn_monster_group(map, group, Point{0, 0}, Point{63, 63}, options, 0, seed++);
+        packs += stats.packs;
+        monsters += stats.monsters;
+        state.pause_timing();
+        map.for_each([](const Submap &sm) {
+            for (MonsterHandle h : sm.monsters()) monster_pool().destroy(h);
+        });
+        state.resume_timing();
+    }
+    state.set_counter("packs_per_call", static_cast<double>(packs) / static_cast<double>(state.iterations()));
+    state.set_counter("monsters_per_call", static_cast<double>(monsters) / static_cast<double>(state.iterations()));
+    state.set_items_processed(state.iterations() * 64 * 64);
+}
+BENCHMARK(BM_SpawnMonsterRegion);
+
+/**
+ * Ten million world items of the dataset's types, created at random
+ * turns over the last 30 days. Built once and kept for every benchmark
+ * that needs it; the items live in their own pool.
+ */
+struct PerishableWorld {
+    Pool<ItemInstance> pool;
+    std::vector<ItemHandle> items;
+    uint64_t now = 30 * 86400;
+};
+
+const PerishableWorld &perishable_world(const bench::Dataset &ds) {
+    static PerishableWorld world;
+    if (world.items.empty()) {
+        Rng rng(11);
+        world.items.reserve(10000000);
+        for (size_t i = 0; i < 10000000; ++i) {
+            const Item &type = ds.items[i % ds.items.size()];
+            world.items.push_back(world.pool.create(ItemInstance{&type, rng.below(30 * 86400)}));
+        }
+    }
+    return world;
+}
+
+/** Look at random items and work out whether they have rotted. */
+void BM_ItemStateLazy(bench::State &state) {
+    const bench::Dataset &ds = bench::dataset(state.size());
+    const PerishableWorld &world = perishable_world(ds);
+    Rng rng(13);
+    size_t rotten = 0;
+    for (auto _ : state) {
+        ItemHandle h = world.items[rng.below(static_cast<uint32_t>(world.items.size()))];
+        rotten += is_rotten(*world.pool.get(h), world.now);
+    }
+    bench::do_not_optimize(rotten);
+    state.set_counter("world_items", static_cast<double>(world.items.size()));
+    state.set_items_processed(state.iterations());
+}
+BENCHMARK(BM_ItemStateLazy);
+
+/**
+ * Baseline: one turn of ticking every world item, advancing a stored
+ * rot value by the item's rate. With lazy state this work does not
+ * exist: a turn costs nothing per idle item.
+ */
+void BM_ItemStateTickAll(bench::State &state) {
+    const bench::Dataset &ds = bench::dataset(state.size());
+    const PerishableWorld &world = perishable_world(ds);
+    std::vector<float> stored(world.items.size(), 0.0f);
+    for (auto _ : state) {
+        for (size_t i = 0; i < world.items.size(); ++i) {
+            const Item *type = world.pool.get(world.items[i])->type;
+            if (type->spoils_in > 0) stored[i] += 1.0f / static_cast<float>(type->spoils_in);
+        }
+    }
+    bench::do_not_optimize(stored.data());
+    state.set_counter("world_items", static_cast<double>(world.items.size()));
+    state.set_items_processed(state.iterations() * world.items.size());
+}
+BENCHMARK(BM_ItemStateTickAll);
+
+/**
+ * A square map `side` submaps across, filled with items at 5% density
+ * and half a monster pack per submap, with the turn it has been
+ * simulated to. Built once per size.
+ */
+struct SimWorld {
+    Map map;
+    uint64_t turn = 0;
+};
+
+SimWorld &sim_world(const bench::Dataset &ds, int side) {
+    static std::map<int, std::unique_ptr<SimWorld>> worlds;
+    std::unique_ptr<SimWorld> &world = worlds[side];
+    if (!world) {
+        world = std::make_unique<SimWorld>();
+        Point last{side - 1, side - 1};
+        spawn_item_group(world->map, widest_group(ds), Point{0, 0}, last, 0.05, 0, 1);
+        for (const MonsterGroup &group : ds.monster_groups) {
+            MonsterSpawnOptions options;
+            options.packs_per_submap = 0.5 / static_cast<double>(ds.monster_groups.size());
+            spawn_monster_group(world->map, group, Point{0, 0}, last, options, 0, 1);
+        }
+    }
+    return *world;
+}
+
+/**
+ * One turn with the player walking across the middle of the map, so
+ * submaps keep entering the active area and being caught up. `radius`
+ * is the active radius; a radius covering the map is the baseline of
+ * ticking every submap every turn. `lod` is the level of detail.
+ */
+void world_turn(bench::State &state, int side, int radius, int lod = 0) {
+    const bench::Dataset &ds = bench::dataset(state.size());
+    SimWorld &world = sim_world(ds, side);
+    Point player{0, side / 2};
+    TurnStats stats;
+    for (auto _ : state) {
+        frame::begin_turn();
+        ++world.turn;
+        // One tile a turn, back and forth across the map.
+        uint64_t x = world.turn % (2 * static_cast<uint64_t>(side) * kSubmapSize);
+        player.x = static_cast<int>(x < static_cast<uint64_t>(side) * kSubmapSize
+                                        ? x
+                                        : 2 * static_cast<uint64_t>(side) * kSubmapSize - 1 - x);
+        stats += simulate_turn(world.map, submap_of(player), radius, world.turn, 1, lod);
+    }
+    double turns = static_cast<double>(state.iterations());
+    state.set_counter("world_submaps", static_cast<double>(world.map.size()));
+    state.set_counter("submaps_per_turn", static_cast<double>(stats.submaps) / turns);
+    state.set_counter("caught_up_per_turn", static_cast<double>(stats.caught_up) / turns);
+    state.set_items_processed(state.iterations());
+}
+
+void BM_WorldTurn16(bench::State &state) { world_turn(state, 16, kActiveRadius); }
+void BM_WorldTurn64(bench::State &state) { world_turn(state, 64, kActiveRadius); }
+void BM_WorldTurn256(bench::State &state) { world_turn(state, 256, kActiveRadius); }
+BENCHMARK(BM_WorldTurn16);
+BENCHMARK(BM_WorldTurn64);
+BENCHMARK(BM_WorldTurn256);
+
+void BM_WorldTurnTickAll16(bench::State &state) { world_turn(state, 16, 16); }
+void BM_WorldTurnTickAll64(bench::State &state) { world_turn(state, 64, 64); }
+void BM_WorldTurnTickAll256(bench::State &state) { world_turn(state, 256, 256); }
+BENCHMARK(BM_WorldTurnTickAll16);
+BENCHMARK(BM_WorldTurnTickAll64);
+BENCHMARK(BM_WorldTurnTickAll256);
+
+// A wide active area on a 64x64 map at each level of detail.
+void BM_WorldTurnLod0(bench::State &state) { world_turn(state, 64, 16, 0); }
+void BM_WorldTurnLod1(bench::State &state) { world_turn(state, 64, 16, 1); }
+void BM_WorldTurnLod2(bench::State &state) { world_turn(state, 64, 16, 2); }
+void BM_WorldTurnLod3(bench::State &state) { world_turn(state, 64, 16, 3); }
+BENCHMARK(BM_WorldTurnLod0);
+BENCHMARK(BM_WorldTurnLod1);
+BENCHMARK(BM_WorldTurnLod2);
+BENCHMARK(BM_WorldTurnLod3);
+
+} // namespace
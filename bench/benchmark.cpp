@@ -0,0 +1,178 @@
+/*
+ * Benchmark runner and entry point for survival_bench.
+ *
+ * Options:
+ *   --size=<n>                    objects per content type (default 10000)
+ *   --benchmark_filter=<text>     run only benchmarks whose name contains text
+ *   --benchmark_min_time=<secs>   minimum timed duration per benchmark (default 0.5)
+ *   --benchmark_out=<file>        also write results as JSON
+ */
+
+#include "benchmark.h"
+
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+namespace {
+
+struct Registered {
+    std::string name;
+    Function fn;
+};
+
+std::vector<Registered> &benchmarks() {
+    static std::vector<Registered> list;
+    return list;
+}
+
+struct Result {
+    std::string name;
+    uint64_t iterations = 0;
+    double real_ns = 0;
+    double cpu_ns = 0;
+    double items_per_second = 0;
+    std::map<std::string, double> counters;
+};
+
+Result run_one(const Registered &b, size_t size, double min_time) {
+    uint64_t iterations = 1;
+    while (true) {
+        State state(iterations, size);
+        b.fn(state);
+        double elapsed = state.real_seconds();
+        // Stop once the run is long enough or the iteration count is
+        // already absurdly large.
+        if (elapsed >= min_time || iterations >= 1000000000ull) {
+            Result r;
+            r.name = b.name + "/" + std::to_string(size);
+            r.iterations = iterations;
+            r.real_ns = elapsed * 1e9 / iterations;
+            r.cpu_ns = state.cpu_seconds() * 1e9 / iterations;
+            if (state.items_processed() > 0 && elapsed > 0) {
+                r.items_per_second = state.items_processed() / elapsed;
+            }
+            r.counters = state.counters();
+            return r;
+        }
+        double multiplier = elapsed > 0 ? 1.4 * min_time / elapsed : 10.0;
+        multiplier = std::min(10.0, std::max(2.0, multiplier));
+        iterations = static_cast<uint64_t>(iterations * multiplier);
+    }
+}
+
+void write_json(std::ostream &out, const std::vector<Result> &results, size_t size) {
+    char date[64];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+    out << std::setprecision(10);
+    out << "{\n  \"context\": {\n"
+        << "    \"date\": \"" << date << "\",\n"
+        << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+        << "    \"dataset_size\": " << size << ",\n"
+#ifdef NDEBUG
+        << "    \"library_build_type\": \"release\"\n"
+#else
+        << "    \"library_build_type\": \"debug\"\n"
+#endif
+        << "  },\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result &r = results[i];
+        out << "    {\n"
+            << "      \"name\": \"" << r.name << "\",\n"
+            << "      \"run_name\": \"" << r.name << "\",\n"
+            << "      \"run_type\": \"iteration\",\n"
+            << "      \"iterations\": " << r.iterations << ",\n"
+            << "      \"real_time\": " << r.real_ns << ",\n"
+            << "      \"cpu_time\": " << r.cpu_ns << ",\n"
+            << "      \"time_unit\": \"ns\"";
+        if (r.items_per_second > 0) {
+            out << ",\n      \"items_per_second\": " << r.items_per_second;
+        }
+        for (const auto &kv : r.counters) {
+            out << ",\n      \"" << kv.first << "\": " << kv.second;
+        }
+        out << "\n    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+} // namespace
+
+int register_benchmark(const char *name, Function fn) {
+    benchmarks().push_back(Registered{name, fn});
+    return static_cast<int>(benchmarks().size());
+}
+
+} // namespace bench
+
+int main(int argc, char **argv) {
+    size_t size = 10000;
+    std::string filter;
+    double min_time = 0.5;
+    std::string out_path;
+    for (int i = 1; i < argc; ++i) {
+        std::string opt = argv[i];
+        try {
+            if (opt.rfind("--size=", 0) == 0) {
+                size = std::stoul(opt.substr(7));
+            } else if (opt.rfind("--benchmark_filter=", 0) == 0) {
+                filter = opt.substr(19);
+            } else if (opt.rfind("--benchmark_min_time=", 0) == 0) {
+                min_time = std::stod(opt.substr(21));
+            } else if (opt.rfind("--benchmark_out=", 0) == 0) {
+                out_path = opt.substr(16);
+            } else {
+                std::cerr << "Unknown option '" << opt << "'." << std::endl;
+                return 1;
+            }
+        } catch (...) {
+            std::cerr << "Invalid value in '" << opt << "'." << std::endl;
+            return 1;
+        }
+    }
+    if (size == 0) {
+        std::cerr << "--size must be positive." << std::endl;
+        return 1;
+    }
+
+    std::vector<bench::Result> results;
+    std::cout << std::left << std::setw(40) << "Benchmark" << std::right
+              << std::setw(16) << "Time (ns)"
+              << std::setw(16) << "CPU (ns)"
+              << std::setw(14) << "Iterations"
+              << std::setw(16) << "items/s" << std::endl;
+    std::cout << std::string(102, '-') << std::endl;
+    for (const auto &b : bench::benchmarks()) {
+        if (!filter.empty() && b.name.find(filter) == std::string::npos) {
+            continue;
+        }
+        bench::Result r = bench::run_one(b, size, min_time);
+        std::cout << std::left << std::setw(40) << r.name << std::right << std::fixed
+                  << std::setw(16) << std::setprecision(1) << r.real_ns
+                  << std::setw(16) << r.cpu_ns
+                  << std::setw(14) << r.iterations
+                  << std::setw(16) << std::setprecision(0) << r.items_per_second;
+        for (const auto &kv : r.counters) {
+            std::cout << "  " << kv.first << "=" << std::setprecision(1) << kv.second;
+        }
+        std::cout << std::endl;
+        results.push_back(r);
+    }
+    if (!out_path.empty()) {
+        std::ofstream out(out_path);
+        if (!out) {
+            std::cerr << "Failed to open " << out_path << std::endl;
+            return 1;
+        }
+        bench::write_json(out, results, size);
+    }
+    return 0;
+}
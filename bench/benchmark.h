@@ -0,0 +1,129 @@
+/*
+ * Minimal Google Benchmark-style harness for the Survival Project.
+ *
+ * Benchmarks are free functions taking a bench::State and registered
+ * with BENCHMARK(fn). The timed region is the range-for over the state:
+ *
+ *     static void BM_Example(bench::State &state) {
+ *         for (auto _ : state) {
+ *             bench::do_not_optimize(work());
+ *         }
+ *         state.set_items_processed(state.iterations());
+ *     }
+ *     BENCHMARK(BM_Example);
+ *
+ * The runner grows the iteration count until a run lasts at least the
+ * minimum time, then reports per-iteration times on the console and,
+ * with --benchmark_out=<file>, as JSON in Google Benchmark's format.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <string>
+
+namespace bench {
+
+class State {
+public:
+    struct [[maybe_unused]] Value {};
+
+    class Iterator {
+    public:
+        Iterator(State *state, uint64_t remaining) : state_(state), remaining_(remaining) {}
+        Value operator*() const { return Value(); }
+        Iterator &operator++() {
+            --remaining_;
+            return *this;
+        }
+        bool operator!=(const Iterator &) {
+            if (remaining_ != 0) {
+                return true;
+            }
+            state_->stop_timer();
+            return false;
+        }
+
+    private:
+        State *state_;
+        uint64_t remaining_;
+    };
+
+    State(uint64_t iterations, size_t size) : iterations_(iterations), size_(size) {}
+
+    Iterator begin() {
+        start_timer();
+        return Iterator(this, iterations_);
+    }
+    Iterator end() { return Iterator(this, 0); }
+
+    /** Number of iterations of the timed loop in this run. */
+    uint64_t iterations() const { return iterations_; }
+
+    /** Size of the synthetic dataset (objects per content type). */
+    size_t size() const { return size_; }
+
+    /** Report throughput as items per second. */
+    void set_items_processed(uint64_t items) { items_processed_ = items; }
+
+    /**
+     * Attach a named value to the result, reported alongside the
+     * timings (like Google Benchmark's user counters).
+     */
+    void set_counter(const std::string &name, double value) { counters_[name] = value; }
+    const std::map<std::string, double> &counters() const { return counters_; }
+
+    /** Exclude setup work inside the loop from the measurement. */
+    void pause_timing() { stop_timer(); }
+    void resume_timing() { start_timer(); }
+
+    double real_seconds() const { return real_ns_ / 1e9; }
+    double cpu_seconds() const { return static_cast<double>(cpu_ticks_) / CLOCKS_PER_SEC; }
+    uint64_t items_processed() const { return items_processed_; }
+
+private:
+    void start_timer() {
+        real_start_ = std::chrono::steady_clock::now();
+        cpu_start_ = std::clock();
+    }
+    void stop_timer() {
+        real_ns_ += static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - real_start_).count());
+        cpu_ticks_ += std::clock() - cpu_start_;
+    }
+
+    uint64_t iterations_;
+    size_t size_;
+    uint64_t items_processed_ = 0;
+    std::map<std::string, double> counters_;
+    double real_ns_ = 0;
+    std::clock_t cpu_ticks_ = 0;
+    std::chrono::steady_clock::time_point real_start_;
+    std::clock_t cpu_start_ = 0;
+};
+
+using Function = void (*)(State &);
+
+/** Register a benchmark; used by the BENCHMARK macro. */
+int register_benchmark(const char *name, Function fn);
+
+/** Prevent the compiler from discarding a computed value. */
+template <typename T>
+inline void do_not_optimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void *sink;
+    sink = &value;
+#endif
+}
+
+} // namespace bench
+
+#define BENCH_CONCAT_INNER(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT_INNER(a, b)
+#define BENCHMARK(fn) \
+    static int BENCH_CONCAT(bench_registered_, __LINE__) = ::bench::register_benchmark(#fn, fn)
@@ -0,0 +1,52 @@
+/*
+ * Generation of the synthetic benchmark datasets declared in dataset.h.
+ */
+
+#include "dataset.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+
+#include "content_gen.h"
+
+namespace bench {
+
+const Dataset &dataset(size_t size) {
+    static std::map<size_t, std::unique_ptr<Dataset>> cache;
+    auto &slot = cache[size];
+    if (slot) {
+        return *slot;
+    }
+    auto dir = std::filesystem::temp_directory_path() / ("survival_bench_" + std::to_string(size));
+    std::filesystem::create_directories(dir);
+    ContentGenOptions options;
+    options.out_dir = dir.string();
+    options.items = size;
+    options.monsters = size;
+    options.recipes = size;
+    options.seed = 12345;
+    ContentGenResult files;
+    if (!generate_content(options, files)) {
+        std::cerr << "Failed to generate benchmark dataset." << std::endl;
+        std::exit(1);
+    }
+    auto ds = std::make_unique<Dataset>();
+    ds->size = size;
+    ds->items_path = files.items_path;
+    ds->recipes_path = files.recipes_path;
+    ds->monsters_path = files.monsters_path;
+    ds->item_groups_path = files.item_groups_path;
+    ds->monster_groups_path = files.monster_groups_path;
+    ds->items = load_items(ds->items_path);
+    ds->recipes = load_recipes(ds->recipes_path);
+    ds->monsters = load_monsters(ds->monsters_path);
+    ds->item_groups = load_item_groups(ds->item_groups_path, ds->items);
+    ds->monster_groups = load_monster_groups(ds->monster_groups_path, ds->monsters);
+    slot = std::move(ds);
+    return *slot;
+}
+
+} // namespace bench
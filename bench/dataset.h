@@ -0,0 +1,41 @@
+/*
+ * Synthetic content used by the benchmarks.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "content.h"
+#include "item_group.h"
+#include "monster_group.h"
+
+namespace bench {
+
+/**
+ * A generated content set: JSON files on disk in the format the loaders
+ * read, plus the same content already loaded into memory.
+ */
+struct Dataset {
+    size_t size = 0;
+    std::string items_path;
+    std::string recipes_path;
+    std::string monsters_path;
+    std::string item_groups_path;
+    std::string monster_groups_path;
+    ItemTable items;
+    RecipeTable recipes;
+    MonsterTable monsters;
+    /** Groups over `items` and `monsters`, declared after them so they are destroyed first. */
+    ItemGroupTable item_groups;
+    MonsterGroupTable monster_groups;
+};
+
+/**
+ * Dataset with `size` objects per content type, written by the content
+ * generator under the system temporary directory on first use and
+ * cached for later calls.
+ */
+const Dataset &dataset(size_t size);
+
+} // namespace bench
@@ -0,0 +1,53 @@
+/*
+ * Walker/Vose alias tables for O(1) weighted sampling.
+ *
+ * A table over n weighted outcomes has n columns of equal probability.
+ * Column i keeps outcome i with probability threshold/2^32 and yields
+ * its alias otherwise, so a sample costs one random draw, one column
+ * read and one compare, however many outcomes there are and however
+ * skewed their weights. Building the table is O(n) and done once, when
+ * content is loaded.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "arena.h"
+#include "rng.h"
+
+struct AliasColumn {
+    uint32_t threshold = 0;
+    uint32_t alias = 0;
+};
+
+/**
+ * Fill `columns` with the alias table of `weights`. Weights need not
+ * be normalized; non-positive weights are never sampled. Leaves
+ * `columns` empty if no weight is positive.
+ */
+void build_alias_table(Span<const double> weights, std::vector<AliasColumn> &columns);
+
+/** Sampler over columns built by build_alias_table(), which it does not own. */
+class AliasTable {
+public:
+    AliasTable() = default;
+    explicit AliasTable(Span<const AliasColumn> columns) : columns_(columns) {}
+
+    size_t size() const { return columns_.size(); }
+    bool empty() const { return columns_.empty(); }
+
+    /** Index of a weighted outcome. The table must not be empty. */
+    uint32_t sample(Rng &rng) const {
+        // The high half of the draw picks the column and the low half
+        // is the coin.
+        uint64_t r = rng.next();
+        uint32_t i = static_cast<uint32_t>(((r >> 32) * columns_.size()) >> 32);
+        const AliasColumn &c = columns_[i];
+        return static_cast<uint32_t>(r) < c.threshold ? i : c.alias;
+    }
+
+private:
+    Span<const AliasColumn> columns_;
+};
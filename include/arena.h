@@ -0,0 +1,201 @@
+/*
+ * Bump arenas and string pooling for long-lived data.
+ *
+ * BumpArena hands out memory from large chunks by advancing a pointer
+ * and frees everything at once when it is destroyed or reset, which
+ * suits content that is built once at startup and then lives for the
+ * whole run. Objects placed in an arena are never destroyed
+ * individually, so only trivially destructible types may be created
+ * in one.
+ *
+ * StringPool stores strings back to back in its own arena and hands
+ * out std::string_view handles that stay valid for the pool's lifetime.
+ * Identical strings are stored once. Pooled strings are NUL-terminated.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Non-owning view of a contiguous array, used for arena-backed lists.
+ */
+template <typename T>
+class Span {
+public:
+    Span() = default;
+    Span(T *data, size_t size) : data_(data), size_(size) {}
+    /** View any contiguous container (vector, Span, ContentTable...). */
+    template <typename Container,
+              typename = std::enable_if_t<
+                  !std::is_same<std::decay_t<Container>, Span>::value &&
+                  std::is_convertible<decltype(std::declval<Container &>().data()), T *>::value>>
+    Span(Container &&c) : data_(c.data()), size_(c.size()) {}
+
+    T *data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    T *begin() const { return data_; }
+    T *end() const { return data_ + size_; }
+    T &operator[](size_t i) const { return data_[i]; }
+    T &front() const { return data_[0]; }
+
+private:
+    T *data_ = nullptr;
+    size_t size_ = 0;
+};
+
+class BumpArena {
+public:
+    explicit BumpArena(size_t chunk_size = 64 * 1024) : chunk_size_(chunk_size) {}
+    BumpArena(BumpArena &&other) noexcept { *this = std::move(other); }
+    BumpArena &operator=(BumpArena &&other) noexcept {
+        if (this != &other) {
+            chunk_size_ = other.chunk_size_;
+            chunks_ = std::move(other.chunks_);
+            cursor_ = std::exchange(other.cursor_, 0);
+            limit_ = std::exchange(other.limit_, 0);
+            used_ = std::exchange(other.used_, 0);
+            reserved_ = std::exchange(other.reserved_, 0);
+            other.chunks_.clear();
+        }
+        return *this;
+    }
+    BumpArena(const BumpArena &) = delete;
+    BumpArena &operator=(const BumpArena &) = delete;
+
+    /** Allocate `size` bytes aligned to `align` (a power of two). */
+    void *allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        uintptr_t p = (cursor_ + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+        if (p + size > limit_) {
+            grow(size + align);
+            p = (cursor_ + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+        }
+        cursor_ = p + size;
+        used_ += size;
+        return reinterpret_cast<void *>(p);
+    }
+
+    /** Construct a T in the arena. */
+    template <typename T, typename... Args>
+    T *create(Args &&...args) {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "arena objects are never destroyed individually");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    /** Copy `count` elements into one contiguous arena block. */
+    template <typename T>
+    Span<T> copy_array(const T *src, size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "arena arrays are copied bytewise");
+        if (count == 0) {
+            return Span<T>();
+        }
+        T *dst = static_cast<T *>(allocate(sizeof(T) * count, alignof(T)));
+        std::memcpy(static_cast<void *>(dst), src, sizeof(T) * count);
+        return Span<T>(dst, count);
+    }
+
+    /** Release every allocation. */
+    void reset() {
+        chunks_.clear();
+        cursor_ = limit_ = 0;
+        used_ = reserved_ = 0;
+    }
+
+    /** Bytes handed out to callers. */
+    size_t bytes_used() const { return used_; }
+    /** Bytes obtained from the heap, including unused chunk tails. */
+    size_t bytes_reserved() const { return reserved_; }
+    /** Number of heap allocations made by the arena. */
+    size_t chunk_count() const { return chunks_.size(); }
+
+private:
+    void grow(size_t min_size) {
+        size_t size = min_size > chunk_size_ ? min_size : chunk_size_;
+        chunks_.emplace_back(new char[size]);
+        cursor_ = reinterpret_cast<uintptr_t>(chunks_.back().get());
+        limit_ = cursor_ + size;
+        reserved_ += size;
+    }
+
+    size_t chunk_size_ = 64 * 1024;
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    uintptr_t cursor_ = 0;
+    uintptr_t limit_ = 0;
+    size_t used_ = 0;
+    size_t reserved_ = 0;
+};
+
+class StringPool {
+public:
+    explicit StringPool(size_t chunk_size = 64 * 1024) : arena_(chunk_size) {}
+    StringPool(StringPool &&) = default;
+    StringPool &operator=(StringPool &&) = default;
+
+    /** Return a pooled copy of `s`, reusing an existing copy if present. */
+    std::string_view intern(std::string_view s) {
+        // The dedup index is an open-addressed table of views so that
+        // interning costs no per-string heap allocation.
+        if ((count_ + 1) * 10 > slots_.size() * 7) {
+            rehash(slots_.empty() ? 1024 : slots_.size() * 2);
+        }
+        size_t mask = slots_.size() - 1;
+        size_t i = std::hash<std::string_view>()(s) & mask;
+        while (slots_[i].data() != nullptr) {
+            if (slots_[i] == s) {
+                return slots_[i];
+            }
+            i = (i + 1) & mask;
+        }
+        char *dst = static_cast<char *>(arena_.allocate(s.size() + 1, 1));
+        std::memcpy(dst, s.data(), s.size());
+        dst[s.size()] = '\0';
+        slots_[i] = std::string_view(dst, s.size());
+        ++count_;
+        return slots_[i];
+    }
+
+    /** Drop the dedup index once no more strings will be added. */
+    void freeze() {
+        std::vector<std::string_view>().swap(slots_);
+        count_ = 0;
+    }
+
+    /** Bytes held by the pooled strings and the dedup index. */
+    size_t bytes_reserved() const {
+        return arena_.bytes_reserved() + slots_.capacity() * sizeof(std::string_view);
+    }
+    size_t bytes_used() const { return arena_.bytes_used(); }
+
+private:
+    void rehash(size_t size) {
+        std::vector<std::string_view> old;
+        old.swap(slots_);
+        slots_.assign(size, std::string_view());
+        size_t mask = size - 1;
+        for (std::string_view v : old) {
+            if (v.data() == nullptr) {
+                continue;
+            }
+            size_t i = std::hash<std::string_view>()(v) & mask;
+            while (slots_[i].data() != nullptr) {
+                i = (i + 1) & mask;
+            }
+            slots_[i] = v;
+        }
+    }
+
+    BumpArena arena_;
+    std::vector<std::string_view> slots_;
+    size_t count_ = 0;
+};
@@ -0,0 +1,52 @@
+/*
+ * Melee combat resolution for the Survival Project.
+ */
+
+#pragma once
+
+#include <memory_resource>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+#include "instances.h"
+#include "player.h"
+
+/**
+ * Outcome of a fight resolved by resolve_combat().
+ */
+struct CombatResult {
+    bool player_won = false;
+    int rounds = 0;
+};
+
+/**
+ * One step of a fight, recorded for narration. Names are views into
+ * content tables.
+ */
+struct CombatEvent {
+    enum class Type { engage, player_hit, monster_defeated, monster_hit, player_killed };
+    Type type;
+    std::string_view monster;
+    std::string_view weapon;
+    int damage = 0;
+    int hp_after = 0;
+};
+
+/**
+ * Events of one fight. Fights resolve within a turn, so logs are
+ * normally backed by the frame allocator.
+ */
+using CombatLog = std::pmr::vector<CombatEvent>;
+
+/**
+ * Fight `enemy` until either side drops to zero hp. The player strikes
+ * first each round, using the first top-level inventory item as a
+ * weapon if any.
+ * Both sides' hp are updated in place. Each step is appended to `log`
+ * when it is non-null.
+ */
+CombatResult resolve_combat(Player &player, MonsterInstance &enemy, CombatLog *log);
+
+/** Narrate a combat log the way the game prints fights. */
+void print_combat_log(std::ostream &out, const CombatLog &log);
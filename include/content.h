@@ -0,0 +1,262 @@
+/*
+ * Content definitions for the Survival Project.
+ *
+ * Items, monsters and recipes are loaded from the JSON files under
+ * data/json using rudimentary line-based parsers that avoid the need
+ * for an external JSON library. The structs below hold only the fields
+ * those parsers understand.
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "arena.h"
+#include "id.h"
+#include "id_set.h"
+
+/**
+ * Materials and flags of item types, as sets of dense ids. The names
+ * behind the ids are kept in process-wide vocabularies filled in by
+ * load_items().
+ */
+using MaterialSet = IdSet<128>;
+using FlagSet = IdSet<256>;
+Vocabulary &material_names();
+Vocabulary &flag_names();
+
+/**
+ * A pocket of a container item, with its limits in grams and
+ * millilitres.
+ */
+struct Pocket {
+    int max_weight = 0;
+    int max_volume = 0;
+};
+
+/**
+ * Structure representing an item definition loaded from JSON.
+ *
+ * String fields of content structs are views into the string pool of
+ * the ContentTable they were loaded into, so they stay valid (and
+ * copies of the struct stay cheap) for as long as that table lives.
+ * Ids are Id values so that lookups compare cached hashes.
+ */
+struct Item {
+    Id id;
+    std::string_view name;
+    std::string_view category;
+    MaterialSet materials;
+    FlagSet flags;
+    /** Weight in grams. */
+    int weight = 0;
+    /** Volume in millilitres. */
+    int volume = 0;
+    /** Turns until a perishable item rots; 0 for items that keep. */
+    int spoils_in = 0;
+    /** Pockets of a container, stored in the owning table's arena. Empty for other items. */
+    Span<const Pocket> pockets;
+};
+
+/**
+ * Structure representing a monster definition loaded from JSON.
+ * Monsters have an identifier, a display name, hit points (hp) and
+ * simple combat attributes.  This struct is intentionally simple and
+ * supports only the fields parsed by load_monsters() below.
+ */
+struct Monster {
+    Id id;
+    std::string_view name;
+    int hp = 0;
+    int melee_dice = 0;
+    int melee_dice_sides = 0;
+    int armor = 0;
+    /** Moves per 100 turns; 100 is one move a turn. */
+    int speed = 100;
+};
+
+/**
+ * A component requirement of a recipe: an item id and quantity.
+ */
+struct Component {
+    Id id;
+    int count = 0;
+};
+
+/**
+ * Recipe structure representing a craftable recipe loaded from JSON.
+ * Each recipe has an id, a resulting item id, and a list of
+ * component requirements stored in the owning table's arena.
+ */
+struct Recipe {
+    Id id;
+    Id result;
+    Span<const Component> components;
+    /** Turns of work the craft takes. */
+    int time = 0;
+};
+
+/**
+ * Immutable, arena-backed collection of one content type.
+ *
+ * Entries are stored in a single contiguous block of the table's bump
+ * arena, and every string they reference lives in the table's string
+ * pool, so a loaded table costs a handful of large allocations instead
+ * of several per entry. Tables are move-only; moving one keeps all
+ * views into it valid.
+ *
+ * Sealing a table also builds an open-addressed index over the entries'
+ * cached id hashes, so find() is a constant-time lookup.
+ */
+template <typename T>
+class ContentTable {
+public:
+    ContentTable() = default;
+    ContentTable(ContentTable &&) = default;
+    ContentTable &operator=(ContentTable &&) = default;
+
+    /** Pool for the strings referenced by entries. Used while loading. */
+    StringPool &strings() { return strings_; }
+    /** Arena for entries and their nested arrays. Used while loading. */
+    BumpArena &arena() { return arena_; }
+
+    /** Copy the finalized entries into the arena and seal the table. */
+    void assign(const std::vector<T> &entries) {
+        entries_ = arena_.copy_array(entries.data(), entries.size());
+        strings_.freeze();
+        build_index();
+    }
+
+    /** Entry with the given id, or nullptr. The first entry wins on duplicates. */
+    const T *find(const Id &id) const {
+        if (index_.empty()) return nullptr;
+        size_t mask = index_.size() - 1;
+        for (size_t i = id.hash() & mask; index_[i] != 0; i = (i + 1) & mask) {
+            const T &entry = entries_[index_[i] - 1];
+            if (entry.id == id) return &entry;
+        }
+        return nullptr;
+    }
+
+    const T *data() const { return entries_.data(); }
+    size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+    const T *begin() const { return entries_.begin(); }
+    const T *end() const { return entries_.end(); }
+    const T &operator[](size_t i) const { return entries_[i]; }
+    const T &front() const { return entries_.front(); }
+
+    /** Heap bytes held for entries (and their index) and for strings. */
+    size_t object_bytes() const { return arena_.bytes_reserved() + index_.capacity() * sizeof(uint32_t); }
+    size_t string_bytes() const { return strings_.bytes_reserved(); }
+
+private:
+    void build_index() {
+        // Slots hold entry index + 1 so that zero marks an empty slot;
+        // the table is kept at most half full.
+        size_t size = 16;
+        while (size < entries_.size() * 2) size *= 2;
+        index_.assign(size, 0);
+        size_t mask = size - 1;
+        for (size_t e = 0; e < entries_.size(); ++e) {
+            size_t i = entries_[e].id.hash() & mask;
+            bool duplicate = false;
+            while (index_[i] != 0 && !duplicate) {
+                duplicate = entries_[index_[i] - 1].id == entries_[e].id;
+                i = (i + 1) & mask;
+            }
+            if (!duplicate) index_[i] = static_cast<uint32_t>(e + 1);
+        }
+    }
+
+    StringPool strings_;
+    BumpArena arena_;
+    Span<T> entries_;
+    std::vector<uint32_t> index_;
+};
+
+using ItemTable = ContentTable<Item>;
+using MonsterTable = ContentTable<Monster>;
+using RecipeTable = ContentTable<Recipe>;
+
+/**
+ * Load recipes from a JSON file. This parser is simplistic and only
+ * extracts the "id", "result", "time" (a duration, see
+ * parse_duration()) and first level of components (assumes each
+ * component entry is a two‑element array [ [ "id", qty ] ]).
+ */
+RecipeTable load_recipes(const std::string &filename);
+
+/**
+ * Load monsters from a JSON file. This parser reads each monster
+ * definition and extracts basic combat attributes. It is line‑based
+ * and similar to load_items and load_recipes, so it should be easy
+ * to extend if more fields are needed. Each monster requires an
+ * "id" field, a "name" given either as a string or as an object
+ * with a "str" subfield, and an "hp" field. Optional fields include
+ * "melee_dice", "melee_dice_sides", "armor" and "speed".
+ */
+MonsterTable load_monsters(const std::string &filename);
+
+/**
+ * Load items from the given JSON file. This function performs a very
+ * simplistic parse that extracts the value of the "id" field, the
+ * "str" field under the "name" object, "weight" (grams, or a string
+ * such as "2 kg") and "volume" (a string such as "250 ml" or "1 L",
+ * or a number of millilitres), "category", and the "material" and
+ * "flags" string arrays, each written on one line, and "spoils_in" (a
+ * duration, see parse_duration()). Containers list their pockets under
+ * "pocket_data", one pocket per line with "max_contains_weight" and
+ * "max_contains_volume" in the same units. Items need an id and a name. If the
+ * file cannot be opened, an empty table is returned and an error is
+ * printed to stderr.
+ */
+ItemTable load_items(const std::string &filename);
+
+/**
+ * Parse a duration such as "30 s", "5 m", "12 h", "3 d" or "1 d 12 h"
+ * into turns of one second. A bare number is a number of turns.
+ * Unknown units are read as turns. Returns -1 if the total does not
+ * fit in an int.
+ */
+int parse_duration(std::string_view text);
+
+/**
+ * Line scanning shared by the content loaders. next_quoted() stores the
+ * first quoted string at or after `from` in `out` and returns the
+ * position past its closing quote, or npos if there is none.
+ * number_after() reads the number after the colon that follows `key`,
+ * or returns `fallback`; it reads in place, so `s` must be part of a
+ * NUL-terminated line.
+ */
+size_t next_quoted(std::string_view s, size_t from, std::string_view &out);
+double number_after(std::string_view s, std::string_view key, double fallback);
+
+/**
+ * Find content by id. Tables are searched through their hash index;
+ * any other list of entries is scanned linearly, comparing cached
+ * hashes first. Returns nullptr when no entry has the given id.
+ */
+const Item *find_item(const ItemTable &items, const Id &id);
+const Recipe *find_recipe(const RecipeTable &recipes, const Id &id);
+const Monster *find_monster(const MonsterTable &monsters, const Id &id);
+const Item *find_item(Span<const Item> items, const Id &id);
+const Recipe *find_recipe(Span<const Recipe> recipes, const Id &id);
+const Monster *find_monster(Span<const Monster> monsters, const Id &id);
+
+/**
+ * Heap memory owned by a content container, split into the container's
+ * own storage and the string payloads that live outside it.
+ */
+struct Footprint {
+    size_t object_bytes = 0;
+    size_t string_bytes = 0;
+    size_t total() const { return object_bytes + string_bytes; }
+};
+
+template <typename T>
+Footprint footprint(const ContentTable<T> &table) {
+    return Footprint{table.object_bytes(), table.string_bytes()};
+}
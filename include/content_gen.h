@@ -0,0 +1,53 @@
+/*
+ * Synthetic content generation for load and scale testing.
+ *
+ * Produces CDDA-shaped items.json, monsters.json, recipes.json,
+ * item_groups.json and monster_groups.json, plus optional mods, laid
+ * out like the repository's data directory. Field
+ * values follow skewed distributions similar to real content (log-normal
+ * weights and volumes, a few very common materials, mostly cheap
+ * recipes) and recipes reference generated item ids, so the output
+ * exercises the loaders and cross-reference lookups the way a large
+ * content set would. Output is deterministic for a given seed.
+ *
+ * Each field is written on its own line so the line-based loaders in
+ * content.cpp can read the files.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+struct ContentGenOptions {
+    /** Directory receiving data/json and data/mods. */
+    std::string out_dir;
+    size_t items = 10000;
+    size_t monsters = 1000;
+    size_t recipes = 5000;
+    /** Item groups over the generated items, some nesting earlier groups. */
+    size_t item_groups = 200;
+    /** Monster groups over the generated monsters, with pack sizes. */
+    size_t monster_groups = 50;
+    /** Number of mods, each adding mod_items items and recipes using them. */
+    size_t mods = 0;
+    size_t mod_items = 1000;
+    uint64_t seed = 1;
+};
+
+/** Paths of the files written by generate_content(). */
+struct ContentGenResult {
+    std::string items_path;
+    std::string monsters_path;
+    std::string recipes_path;
+    std::string item_groups_path;
+    std::string monster_groups_path;
+    std::string mods_dir;
+};
+
+/**
+ * Write a synthetic content set and fill `result` with the paths.
+ * Returns false (after printing an error to stderr) if a directory or
+ * file cannot be written.
+ */
+bool generate_content(const ContentGenOptions &options, ContentGenResult &result);
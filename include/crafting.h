@@ -0,0 +1,87 @@
+/*
+ * Crafting rules for the Survival Project.
+ *
+ * Crafting takes the recipe's time. A craft is an activity: the
+ * components are used up when it starts, the work then advances with
+ * game time, and the result is made when the work is done. A craft can
+ * be interrupted, by a monster coming close, and resumed later with the
+ * work done so far kept.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "content.h"
+#include "horde.h"
+#include "map.h"
+#include "player.h"
+
+/**
+ * Check whether the player's inventory holds every component the
+ * recipe requires, without modifying the inventory.
+ */
+bool has_components(const Player &player, const Recipe &recipe);
+
+/**
+ * Remove the recipe's components from the player's inventory and
+ * destroy them. If any component is missing, items already removed are
+ * returned to the inventory and false is returned.
+ */
+bool consume_components(Player &player, const Recipe &recipe);
+
+/**
+ * Create an instance of the item a recipe produces at turn `turn`,
+ * looking its definition up in `items`. Returns an invalid handle when the result
+ * id is not a known item.
+ */
+ItemHandle make_result(const Recipe &recipe, Span<const Item> items, uint64_t turn);
+
+/** A monster within this many tiles interrupts a craft. */
+constexpr int kInterruptDistance = 5;
+
+/**
+ * Turns that can pass before anything could interrupt a craft on tile
+ * `tile` at turn `now`: no monster within `radius` submaps can walk to
+ * within kInterruptDistance sooner, and no collapsed horde can expand
+ * into that area sooner (see Hordes::quiet_turns()). Meant as the
+ * `safe_turns()` of work_on().
+ */
+uint64_t craft_safe_turns(const Map &map, const Hordes &hordes, Point tile, int radius, uint64_t now);
+
+/** A craft in progress, or none. */
+struct CraftProgress {
+    const Recipe *recipe = nullptr;
+    /** Turns of work done so far. */
+    uint64_t done = 0;
+
+    bool active() const { return recipe != nullptr; }
+    /** Turns of work left. */
+    uint64_t remaining() const {
+        uint64_t time = static_cast<uint64_t>(std::max(recipe->time, 0));
+        return time > done ? time - done : 0;
+    }
+};
+
+/**
+ * Work on `craft` until it is done or something interrupts it.
+ * `safe_turns()` tells how many turns can pass before anything could
+ * interrupt the craft: 0 to stop now, UINT64_MAX if nothing can.
+ * `pass(n)` lets n turns of game time pass. Time passes in batches of
+ * safe turns, so the work done is counted once per batch rather than
+ * checked turn by turn, and a craft with nothing around to interrupt
+ * it completes in a single batch. Returns the turns worked.
+ */
+template <typename Safe, typename Pass>
+uint64_t work_on(CraftProgress &craft, Safe &&safe_turns, Pass &&pass) {
+    uint64_t worked = 0;
+    while (craft.remaining() > 0) {
+        uint64_t batch = std::min(craft.remaining(), static_cast<uint64_t>(safe_turns()));
+        if (batch == 0) break;
+        pass(batch);
+        craft.done += batch;
+        worked += batch;
+    }
+    return worked;
+}
@@ -0,0 +1,82 @@
+/*
+ * Map fields: fire, smoke and toxic gas.
+ *
+ * A field lies on a tile with an intensity from 1 to 3. Each submap with
+ * fields on it owns a FieldLayer holding the intensity of every field
+ * type on each of its tiles, plus the set of tiles that have any field
+ * at all. Fields spread and decay every turn (see simulation.h), and
+ * that work runs over the active set only: a tile joins it when a field
+ * appears on it and leaves once every field on it has died down, so a
+ * turn costs nothing for tiles without fields, and nothing at all for
+ * submaps that never had any.
+ *
+ * Fire burns each tile once. A tile that has burnt is marked, and fire
+ * spreading from its neighbours passes it by, so a blaze moves across
+ * the map as a front and burns out behind itself.
+ */
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "arena.h"
+
+enum class FieldType : uint8_t { fire, smoke, toxic_gas };
+
+constexpr int kFieldTypes = 3;
+
+/** How a field type behaves from turn to turn. */
+struct FieldInfo {
+    const char *name;
+    /** Map glyph. */
+    char glyph;
+    /** Chance per turn that the field loses one intensity. */
+    double decay;
+    /**
+     * Fire: chance per turn, at full intensity, to set each unburnt
+     * orthogonal neighbour alight. Smoke and gas: chance per turn to
+     * drift one intensity to a random orthogonal neighbour.
+     */
+    double spread;
+};
+
+const FieldInfo &field_info(FieldType type);
+
+/** Field type by name ("fire", "smoke", "toxic_gas"); false if unknown. */
+bool parse_field_type(std::string_view name, FieldType &type);
+
+class FieldLayer {
+public:
+    static constexpr int kMaxIntensity = 3;
+    // Room for tile indices of a 12x12 submap.
+    static constexpr int kTiles = 144;
+
+    int intensity(int tile, FieldType type) const { return intensity_[tile][static_cast<int>(type)]; }
+
+    /** Raise a field on a tile, up to kMaxIntensity, adding the tile to the active set. */
+    void add(int tile, FieldType type, int amount);
+    /** Lower a field on a tile, down to nothing. The tile stays in the active set until compact(). */
+    void remove(int tile, FieldType type, int amount);
+    /** Set a tile alight unless it has burnt before. Returns whether it caught. */
+    bool ignite(int tile, int intensity);
+    bool burnt(int tile) const { return burnt_[tile]; }
+
+    /** Tiles that may have fields on them, in the order they became active. */
+    Span<const uint16_t> active() const { return active_; }
+    bool empty() const { return active_.empty(); }
+    /** Drop the tiles with no field left from the active set. */
+    void compact();
+
+    size_t bytes_reserved() const { return sizeof(FieldLayer) + active_.capacity() * sizeof(uint16_t); }
+
+private:
+    std::array<std::array<uint8_t, kFieldTypes>, kTiles> intensity_{};
+    std::vector<uint16_t> active_;
+    std::bitset<kTiles> in_active_;
+    std::bitset<kTiles> burnt_;
+};
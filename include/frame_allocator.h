@@ -0,0 +1,93 @@
+/*
+ * Per-turn frame allocator for transient simulation data.
+ *
+ * Every thread owns a FrameArena, a linear std::pmr::memory_resource
+ * that is rewound at the start of each turn instead of freeing
+ * individual blocks. Anything that lives for at most one turn (combat
+ * logs, candidate lists, scratch buffers) can be allocated from it:
+ *
+ *     std::pmr::vector<Item> candidates(frame::resource());
+ *
+ * Memory from the frame arena is valid until the next begin_turn().
+ * Threads rewind lazily: an arena notices that a new turn has started
+ * the first time it is used afterwards, so worker threads need no
+ * coordination with the main loop. After a turn that needed more than
+ * one block, the arena replaces them with a single block of the
+ * combined size, so steady-state turns make no heap allocations.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace frame {
+
+class FrameArena : public std::pmr::memory_resource {
+public:
+    explicit FrameArena(size_t initial_size = 64 * 1024);
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    /** Release every allocation made since the last reset. */
+    void reset();
+
+    /** Bytes handed out since the last reset. */
+    size_t bytes_used() const { return used_; }
+    /** Bytes currently held from the heap. */
+    size_t bytes_reserved() const { return reserved_; }
+
+protected:
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    void add_block(size_t min_size);
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    std::vector<size_t> block_sizes_;
+    uintptr_t cursor_ = 0;
+    uintptr_t limit_ = 0;
+    size_t used_ = 0;
+    size_t reserved_ = 0;
+    size_t initial_size_;
+    uint64_t turn_ = 0;
+
+    friend FrameArena &arena();
+};
+
+/** Allocation counts for one completed turn. */
+struct TurnStats {
+    uint64_t turn = 0;
+    uint64_t frame_allocations = 0;
+    uint64_t frame_bytes = 0;
+    uint64_t heap_allocations = 0;
+};
+
+/**
+ * Start a new turn. Frame memory from the previous turn becomes
+ * invalid, and that turn's allocation counts are recorded.
+ */
+void begin_turn();
+
+/** Number of turns started so far. */
+uint64_t current_turn();
+
+/** Counts for the most recently completed turn. */
+TurnStats last_turn();
+
+/** The calling thread's frame arena, rewound if a new turn began. */
+FrameArena &arena();
+
+/** The calling thread's frame arena as a memory resource. */
+inline std::pmr::memory_resource *resource() {
+    return &arena();
+}
+
+} // namespace frame
@@ -0,0 +1,131 @@
+/*
+ * Hordes: monsters roaming the overmap in bulk.
+ *
+ * Far from the player, a horde is one entry: the overmap tile it is on,
+ * where it is heading, and how many monsters of each type it holds,
+ * drawn from a monster group. Every kHordeMoveInterval turns each horde
+ * shambles one overmap tile towards its destination, and picks a new
+ * one nearby once it arrives, so moving thousands of monsters costs one
+ * step per horde rather than one per monster per turn.
+ *
+ * When a horde's overmap tile reaches the active area (see
+ * simulation.h), it is expanded: its monsters become individual
+ * instances scattered over the tile's submaps, and wander and fight
+ * like any other. Once none of them is left within one submap of the
+ * active area, the horde is collapsed back into counts on the overmap
+ * tile where most of them ended up. The extra submap of margin keeps a
+ * player walking along the edge from expanding and collapsing the same
+ * horde every few turns, and a collapsed horde is not expanded again
+ * before it has taken a step or the active area has moved.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "content.h"
+#include "instances.h"
+#include "map.h"
+#include "monster_group.h"
+#include "overmap.h"
+#include "point.h"
+#include "rng.h"
+
+/** Turns a horde takes to cross one overmap tile, about half a monster's walking speed. */
+constexpr uint64_t kHordeMoveInterval = 48;
+/** Hordes pick destinations within this many overmap tiles of where they are. */
+constexpr int kHordeRoam = 12;
+
+struct HordeMember {
+    const Monster *type = nullptr;
+    uint32_t count = 0;
+};
+
+struct Horde {
+    /** Overmap tile the horde is on, while collapsed. */
+    Point omt;
+    Point destination;
+    /** Monsters of each type, while collapsed. */
+    std::vector<HordeMember> members;
+    /** Individual monsters, while expanded. */
+    std::vector<MonsterHandle> monsters;
+    bool expanded = false;
+
+    /** Number of monsters in the horde. */
+    size_t size() const;
+};
+
+struct HordeStats {
+    /** Overmap tiles walked by collapsed hordes. */
+    size_t steps = 0;
+    size_t expanded = 0;
+    size_t collapsed = 0;
+    /** Monsters placed on the map by expanding hordes. */
+    size_t placed = 0;
+    /** Monsters taken off the map by collapsing hordes. */
+    size_t gathered = 0;
+
+    HordeStats &operator+=(const HordeStats &o) {
+        steps += o.steps;
+        expanded += o.expanded;
+        collapsed += o.collapsed;
+        placed += o.placed;
+        gathered += o.gathered;
+        return *this;
+    }
+};
+
+class Hordes {
+public:
+    /**
+     * Add `count` hordes of `min_size` to `max_size` monsters drawn from
+     * `group`, on random tiles of `overmap`; hordes gather in cities,
+     * so city tiles are strongly preferred. Returns the number of
+     * monsters added.
+     */
+    size_t populate(const Overmap &overmap, const MonsterGroup &group, size_t count, int min_size, int max_size,
+                    uint64_t seed);
+
+    /**
+     * Bring the hordes up to turn `turn`, with the active area being the
+     * submaps within `radius` of `center`: move collapsed hordes by the
+     * steps that fell due since the last update, then expand the hordes
+     * that reached the active area and collapse those that left it.
+     * Does nothing if no step fell due and the active area has not
+     * moved. Call after the turn's simulate_turn(), so that expanded
+     * monsters first move on the next turn.
+     */
+    HordeStats update(Map &map, Point center, int radius, uint64_t turn, uint64_t seed);
+
+    /** First turn after `turn` on which hordes take a step. */
+    static uint64_t next_step(uint64_t turn) { return (turn / kHordeMoveInterval + 1) * kHordeMoveInterval; }
+
+    /**
+     * Turns that can pass from `now` before a collapsed horde could be
+     * expanded into the active area of `radius` submaps around `center`,
+     * counting the steps each needs to reach it; UINT64_MAX if there is
+     * no collapsed horde. Batches of turns that stop at the monsters'
+     * distance (see nearest_monster()) should stop here too.
+     */
+    uint64_t quiet_turns(Point center, int radius, uint64_t now) const;
+
+    const std::vector<Horde> &hordes() const { return hordes_; }
+    size_t size() const { return hordes_.size(); }
+    /** Monsters in all hordes, expanded or not. */
+    size_t monster_count() const;
+    size_t bytes_reserved() const;
+
+private:
+    void step(Horde &horde, Rng &rng);
+    size_t expand(Map &map, Horde &horde, uint64_t turn, uint64_t seed, Rng &rng);
+    size_t collapse(Map &map, Horde &horde);
+
+    std::vector<Horde> hordes_;
+    // Turn the hordes have been moved up to, and the active area they
+    // were last expanded and collapsed against.
+    uint64_t moved_ = 0;
+    Point center_;
+    int radius_ = -1;
+};
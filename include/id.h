@@ -0,0 +1,88 @@
+/*
+ * Content identifiers with inline storage and a cached hash.
+ *
+ * Ids such as "example_item" are compared and hashed far more often
+ * than they are created, so Id computes its hash once at construction
+ * and compares hashes before looking at any characters. Ids of up to
+ * kInlineCapacity characters (which covers nearly all of them) are
+ * stored inside the object. Longer ids are not copied: they view the
+ * caller's characters, which for content is the owning table's string
+ * pool, so such an Id must not outlive the string it was made from.
+ *
+ * Id is 32 bytes and trivially copyable, so content structs holding
+ * ids can still be copied into arenas bytewise.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+class Id {
+public:
+    static constexpr size_t kInlineCapacity = 20;
+
+    Id() : hash_(hash_bytes(std::string_view())) {}
+    Id(std::string_view s) : hash_(hash_bytes(s)), size_(static_cast<uint32_t>(s.size())) {
+        if (s.size() <= kInlineCapacity) {
+            std::memcpy(inline_, s.data(), s.size());
+        } else {
+            const char *external = s.data();
+            std::memcpy(inline_, &external, sizeof(external));
+        }
+    }
+    Id(const char *s) : Id(std::string_view(s)) {}
+    Id(const std::string &s) : Id(std::string_view(s)) {}
+
+    std::string_view view() const {
+        if (size_ <= kInlineCapacity) {
+            return std::string_view(inline_, size_);
+        }
+        const char *external;
+        std::memcpy(&external, inline_, sizeof(external));
+        return std::string_view(external, size_);
+    }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    /** Hash computed at construction. */
+    uint64_t hash() const { return hash_; }
+
+    bool operator==(const Id &o) const {
+        if (hash_ != o.hash_ || size_ != o.size_) return false;
+        if (size_ <= kInlineCapacity) return std::memcmp(inline_, o.inline_, size_) == 0;
+        return view() == o.view();
+    }
+    bool operator!=(const Id &o) const { return !(*this == o); }
+
+    /** 64-bit FNV-1a, the hash Ids cache. */
+    static uint64_t hash_bytes(std::string_view s) {
+        uint64_t h = 14695981039346656037ull;
+        for (unsigned char c : s) {
+            h ^= c;
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+private:
+    uint64_t hash_;
+    uint32_t size_ = 0;
+    // Characters of short ids, or the pointer to those of long ones.
+    char inline_[kInlineCapacity];
+};
+
+inline std::ostream &operator<<(std::ostream &out, const Id &id) {
+    return out << id.view();
+}
+
+namespace std {
+template <>
+struct hash<Id> {
+    size_t operator()(const Id &id) const { return static_cast<size_t>(id.hash()); }
+};
+} // namespace std
@@ -0,0 +1,133 @@
+/*
+ * Dense ids and fixed-width sets of them.
+ *
+ * A Vocabulary maps the names of a small closed set of things (item
+ * materials, item flags) to dense integer ids, assigned in order of
+ * first appearance. Content records membership in such a set as an
+ * IdSet: a fixed number of 64-bit words with one bit per id. Set
+ * tests are then a handful of branch-free word operations that the
+ * compiler can keep in vector registers, instead of string compares
+ * against a list of names, and a whole table of sets can be filtered
+ * with the bulk helpers below.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "arena.h"
+
+template <size_t Bits>
+class IdSet {
+public:
+    static_assert(Bits % 64 == 0, "IdSet width must be a multiple of 64");
+    static constexpr size_t kBits = Bits;
+    static constexpr size_t kWords = Bits / 64;
+
+    void set(size_t id) { words_[id / 64] |= uint64_t(1) << (id % 64); }
+    void reset(size_t id) { words_[id / 64] &= ~(uint64_t(1) << (id % 64)); }
+    bool test(size_t id) const { return (words_[id / 64] >> (id % 64)) & 1; }
+
+    /** True if this set and `other` share at least one id. */
+    bool any_of(const IdSet &other) const {
+        uint64_t acc = 0;
+        for (size_t i = 0; i < kWords; ++i) acc |= words_[i] & other.words_[i];
+        return acc != 0;
+    }
+    /** True if every id in `other` is also in this set. */
+    bool all_of(const IdSet &other) const {
+        uint64_t missing = 0;
+        for (size_t i = 0; i < kWords; ++i) missing |= other.words_[i] & ~words_[i];
+        return missing == 0;
+    }
+    bool empty() const {
+        uint64_t acc = 0;
+        for (size_t i = 0; i < kWords; ++i) acc |= words_[i];
+        return acc == 0;
+    }
+    size_t count() const {
+        size_t n = 0;
+        for (size_t i = 0; i < kWords; ++i) n += static_cast<size_t>(__builtin_popcountll(words_[i]));
+        return n;
+    }
+
+    /** Call `f(id)` for every id in the set, in increasing order. */
+    template <typename F>
+    void for_each(F &&f) const {
+        for (size_t i = 0; i < kWords; ++i) {
+            for (uint64_t w = words_[i]; w != 0; w &= w - 1) {
+                f(i * 64 + static_cast<size_t>(__builtin_ctzll(w)));
+            }
+        }
+    }
+
+    bool operator==(const IdSet &o) const {
+        uint64_t diff = 0;
+        for (size_t i = 0; i < kWords; ++i) diff |= words_[i] ^ o.words_[i];
+        return diff == 0;
+    }
+    bool operator!=(const IdSet &o) const { return !(*this == o); }
+
+private:
+    uint64_t words_[kWords] = {};
+};
+
+/**
+ * Interns names to dense ids below a fixed capacity. Safe to use from
+ * several loader threads at once.
+ */
+class Vocabulary {
+public:
+    static constexpr uint32_t kInvalid = UINT32_MAX;
+
+    Vocabulary(const char *what, size_t capacity) : what_(what), capacity_(capacity) {}
+
+    /**
+     * Id of `name`, assigning the next free one on first use. Returns
+     * kInvalid (and reports once on stderr) when the vocabulary is full.
+     */
+    uint32_t intern(std::string_view name);
+    /** Id of `name`, or kInvalid if it was never interned. */
+    uint32_t find(std::string_view name) const;
+    /** Name of an id returned by intern(). */
+    std::string name(uint32_t id) const;
+    size_t size() const;
+
+private:
+    const char *what_;
+    size_t capacity_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, uint32_t> ids_;
+    std::vector<std::string> names_;
+    bool overflow_reported_ = false;
+};
+
+/**
+ * Select the positions of sets that share an id with `mask` (any) or
+ * contain all of it (all). `get` maps an element of `items` to its set,
+ * so the helpers work on tables of structs as well as on plain arrays
+ * of sets. Matches are appended to `out`; returns the number appended.
+ */
+template <typename T, typename Get, size_t Bits>
+size_t select_any(Span<const T> items, Get get, const IdSet<Bits> &mask, std::vector<uint32_t> &out) {
+    size_t before = out.size();
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (get(items[i]).any_of(mask)) out.push_back(static_cast<uint32_t>(i));
+    }
+    return out.size() - before;
+}
+
+template <typename T, typename Get, size_t Bits>
+size_t select_all(Span<const T> items, Get get, const IdSet<Bits> &mask, std::vector<uint32_t> &out) {
+    size_t before = out.size();
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (get(items[i]).all_of(mask)) out.push_back(static_cast<uint32_t>(i));
+    }
+    return out.size() - before;
+}
@@ -0,0 +1,107 @@
+/*
+ * Item and monster instances for the Survival Project.
+ *
+ * Content tables hold one immutable definition per item or monster
+ * type. Everything that exists in the game (an item lying in the world
+ * or carried by the player, a monster being fought) is an instance
+ * that points at its definition and lives in a pool. World and
+ * inventory lists hold handles, so picking up or dropping an item
+ * moves a handle rather than copying the item, and a handle kept after
+ * its item was consumed is detected as stale.
+ *
+ * Time-dependent item state is never ticked. An instance records the
+ * turn it was created, and state such as spoilage is computed from its
+ * age and the rates in its definition whenever it is looked at, so an
+ * item lying untouched costs nothing per turn however many there are.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "arena.h"
+#include "content.h"
+#include "point.h"
+#include "pool.h"
+
+/** An item that exists in the game. */
+struct ItemInstance {
+    const Item *type = nullptr;
+    /** Turn the item was created, the origin of its time-dependent state. */
+    uint64_t created = 0;
+};
+
+/** A monster that exists in the game, with its own hit points. */
+struct MonsterInstance {
+    const Monster *type = nullptr;
+    int hp = 0;
+    /** Tile position of a monster on the map. */
+    Point pos;
+    /** Turn the monster's movement on the map has been simulated up to. */
+    uint64_t updated = 0;
+};
+
+using ItemHandle = Handle<ItemInstance>;
+using MonsterHandle = Handle<MonsterInstance>;
+
+/**
+ * Pools holding every item and monster instance. Main thread only.
+ * Defined inline so that handle lookups in hot loops inline fully.
+ */
+inline Pool<ItemInstance> &item_pool() {
+    static Pool<ItemInstance> pool;
+    return pool;
+}
+
+inline Pool<MonsterInstance> &monster_pool() {
+    static Pool<MonsterInstance> pool;
+    return pool;
+}
+
+/** Create an instance of the given definition at turn `turn`. */
+ItemHandle spawn_item(const Item &type, uint64_t turn = 0);
+MonsterHandle spawn_monster(const Monster &type, Point pos = Point(), uint64_t turn = 0);
+
+/** Definition of the item a handle refers to, or nullptr if it is stale. */
+inline const Item *item_type(ItemHandle h) {
+    const ItemInstance *item = item_pool().get(h);
+    return item ? item->type : nullptr;
+}
+
+/**
+ * Share of its shelf life a perishable item has used up at turn `now`:
+ * 0 when created, 1 when it rots. Always 0 for items that keep.
+ */
+inline double rot(const ItemInstance &item, uint64_t now) {
+    int shelf_life = item.type->spoils_in;
+    if (shelf_life <= 0 || now <= item.created) return 0;
+    return static_cast<double>(now - item.created) / shelf_life;
+}
+
+inline bool is_rotten(const ItemInstance &item, uint64_t now) {
+    return rot(item, now) >= 1;
+}
+
+/**
+ * Suffix describing an item's freshness at turn `now` for listings:
+ * " (rotten)", " (old)" past 90% of its shelf life, or empty.
+ */
+std::string_view freshness_label(ItemHandle h, uint64_t now);
+
+/**
+ * First handle in `items` whose item has the given type id, or nullptr.
+ * Stale handles are skipped.
+ */
+const ItemHandle *find_handle(Span<const ItemHandle> items, const Id &id);
+
+/** Footprint of a list of item handles (world or inventory). */
+Footprint footprint(const std::vector<ItemHandle> &items);
+
+/** Slot storage held by a pool, live or free. */
+template <typename T>
+Footprint footprint(const Pool<T> &pool) {
+    return Footprint{pool.bytes_reserved(), 0};
+}
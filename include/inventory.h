@@ -0,0 +1,203 @@
+/*
+ * Nested inventories for the Survival Project.
+ *
+ * An inventory is a tree: the root stands for the character, container
+ * items hang below it, each container has one node per pocket, and
+ * pockets hold further items (backpack -> pouch -> bandages). All nodes
+ * live in one flat vector and refer to each other by index, with freed
+ * nodes reused by later inserts. Item handles are kept in a parallel
+ * vector so that scans over the items touch 8 bytes per node.
+ *
+ * Every node caches aggregates over its subtree: the total weight and
+ * number of items below it, and, for pockets and the root, the volume
+ * of the items directly inside. Inserting or removing an item updates
+ * those caches along the path to the root, so weight and count queries
+ * are O(1) and checking whether an item fits a pocket is O(depth),
+ * however many items the inventory holds.
+ *
+ * Volume is only counted against the pocket an item sits in: a rigid
+ * container takes up its own volume in its parent whatever it holds.
+ * Weight counts against every enclosing pocket and the root.
+ *
+ * Items are also indexed by category, material and flag (the latter
+ * two by their dense ids). Each index entry is a list of nodes kept
+ * sorted by item name, so a filtered
+ * listing such as "everything steel" is already sorted and costs
+ * O(matches). Inserts and removals update the lists in place.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "content.h"
+#include "id.h"
+#include "instances.h"
+
+class Inventory {
+public:
+    using NodeId = uint32_t;
+    static constexpr NodeId kRoot = 0;
+    static constexpr NodeId kNone = UINT32_MAX;
+
+    /** Properties items are indexed by. */
+    enum class Facet { category, material, flag, count };
+
+    /** Create an empty inventory whose root holds at most the given weight (g) and volume (ml). */
+    explicit Inventory(int64_t max_weight = INT64_MAX, int64_t max_volume = INT64_MAX);
+
+    /**
+     * Whether an item of the given type fits in `pocket` (a pocket node
+     * or the root): the pocket must have room for its volume, and it
+     * and every enclosing pocket must have room for its weight.
+     */
+    bool fits(const Item &type, NodeId pocket) const;
+
+    /**
+     * A pocket that fits an item of the given type, preferring
+     * container pockets in the order they were added over the root.
+     * Returns kNone if nothing fits. Costs O(pockets x depth), or O(1)
+     * when the item would exceed the root's weight limit.
+     */
+    NodeId find_space(const Item &type) const;
+
+    /**
+     * Put an item into `pocket` (a pocket node or the root) and return
+     * its node. Limits are not checked; see fits(). Containers get one
+     * empty pocket node per pocket of their type.
+     */
+    NodeId insert(ItemHandle item, NodeId pocket = kRoot);
+
+    /**
+     * Remove an item node and everything inside it. Handles of the
+     * items that were inside are appended to `contents`.
+     */
+    void remove(NodeId node, std::vector<ItemHandle> &contents);
+
+    /** First item node whose type has the given id, or kNone. */
+    NodeId find(const Id &id) const;
+
+    /** Remove every item. Item handles are not destroyed. */
+    void clear();
+
+    /** Number of items, including those inside containers. */
+    size_t size() const { return nodes_[kRoot].count; }
+    bool empty() const { return size() == 0; }
+
+    ItemHandle item(NodeId n) const { return handles_[n]; }
+    /**
+     * Definition of an item node, cached at insert so that scans need no
+     * pool lookups. Stays valid even if the item's handle goes stale.
+     */
+    const Item *type(NodeId n) const { return types_[n]; }
+    bool is_pocket(NodeId n) const { return nodes_[n].kind == Kind::pocket; }
+    NodeId parent(NodeId n) const { return nodes_[n].parent; }
+    NodeId first_child(NodeId n) const { return nodes_[n].first_child; }
+    NodeId next_sibling(NodeId n) const { return nodes_[n].next_sibling; }
+
+    /** Weight of a node's subtree: an item with its contents, or a pocket's contents. */
+    int64_t weight(NodeId n) const { return nodes_[n].weight; }
+    /** Items in a node's subtree, counting the node itself if it is an item. */
+    uint32_t count(NodeId n) const { return nodes_[n].count; }
+    /** Volume of the items directly inside a pocket or the root. */
+    int64_t contained_volume(NodeId n) const { return nodes_[n].volume; }
+    /** Limits of a pocket or the root. */
+    int64_t max_weight(NodeId n) const { return nodes_[n].max_weight; }
+    int64_t max_volume(NodeId n) const { return nodes_[n].max_volume; }
+
+    /**
+     * Item nodes whose category, material or flag equals `key`, sorted
+     * by item name. The view is invalidated by the next insert or remove.
+     */
+    Span<const NodeId> with(Facet facet, const Id &key) const;
+
+    /** Call `f(node, handle)` for every item, in storage order. */
+    template <typename F>
+    void for_each_item(F &&f) const {
+        for (NodeId n = 0; n < handles_.size(); ++n) {
+            if (handles_[n].valid()) f(n, handles_[n]);
+        }
+    }
+
+    /**
+     * Call `f(node, depth)` for every item in depth-first order, where
+     * top-level items have depth 0 and the contents of a container have
+     * its depth plus one.
+     */
+    template <typename F>
+    void walk(F &&f) const {
+        walk(kRoot, -1, f);
+    }
+
+    /** Heap bytes held for nodes. */
+    size_t bytes_reserved() const {
+        size_t bytes = nodes_.capacity() * sizeof(Node) + handles_.capacity() * sizeof(ItemHandle) +
+                       types_.capacity() * sizeof(const Item *) + free_.capacity() * sizeof(NodeId) +
+                       pockets_.capacity() * sizeof(NodeId);
+        bytes += categories_.bucket_count() * sizeof(void *);
+        for (const auto &entry : categories_) {
+            bytes += sizeof(entry) + entry.second.capacity() * sizeof(NodeId);
+        }
+        for (const auto &list : materials_) bytes += sizeof(list) + list.capacity() * sizeof(NodeId);
+        for (const auto &list : flags_) bytes += sizeof(list) + list.capacity() * sizeof(NodeId);
+        return bytes;
+    }
+
+private:
+    enum class Kind : uint8_t { free, root, item, pocket };
+
+    struct Node {
+        NodeId parent = kNone;
+        NodeId first_child = kNone;
+        NodeId last_child = kNone;
+        NodeId next_sibling = kNone;
+        NodeId prev_sibling = kNone;
+        Kind kind = Kind::free;
+        uint32_t count = 0;
+        int64_t weight = 0;
+        int64_t volume = 0;
+        int64_t max_weight = 0;
+        int64_t max_volume = 0;
+    };
+
+    NodeId allocate(Kind kind, NodeId parent);
+    void release(NodeId n, std::vector<ItemHandle> &contents);
+    void index_insert(NodeId n);
+    void index_remove(NodeId n);
+    /** Apply `f(list)` to every index list an item belongs to. */
+    template <typename F>
+    void for_each_key(const Item &type, F &&f);
+
+    template <typename F>
+    void walk(NodeId n, int depth, F &f) const {
+        for (NodeId c = nodes_[n].first_child; c != kNone; c = nodes_[c].next_sibling) {
+            if (nodes_[c].kind == Kind::item) {
+                f(c, depth + 1);
+                walk(c, depth + 1, f);
+            } else {
+                // Pockets are transparent: their items sit one level
+                // below the container.
+                walk(c, depth, f);
+            }
+        }
+    }
+
+    std::vector<Node> nodes_;
+    // Handle and definition of each item node; invalid/null for
+    // pockets, the root and free nodes.
+    std::vector<ItemHandle> handles_;
+    std::vector<const Item *> types_;
+    std::vector<NodeId> free_;
+    std::vector<NodeId> pockets_;
+    std::unordered_map<Id, std::vector<NodeId>> categories_;
+    std::vector<std::vector<NodeId>> materials_;
+    std::vector<std::vector<NodeId>> flags_;
+};
+
+/** Node storage held by an inventory. */
+inline Footprint footprint(const Inventory &inventory) {
+    return Footprint{inventory.bytes_reserved(), 0};
+}
@@ -0,0 +1,77 @@
+/*
+ * Item groups (weighted loot tables) for the Survival Project.
+ *
+ * An item group lists items and other groups with relative weights,
+ * CDDA-style:
+ *
+ *     {
+ *       "type": "item_group",
+ *       "id": "camping",
+ *       "items": [
+ *         [ "backpack", 10 ],
+ *         { "item": "pouch", "prob": 30 },
+ *         { "group": "tools", "prob": 20 }
+ *       ]
+ *     }
+ *
+ * Each roll of a group yields one item. Nested groups are flattened at
+ * load time into one distribution over item types (a nested entry of
+ * weight w passes w times its own probabilities down to its items), and
+ * that distribution is compiled into an alias table, so sampling a
+ * group costs the same O(1) however deep or wide it is.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "alias_table.h"
+#include "content.h"
+#include "id.h"
+#include "map.h"
+#include "rng.h"
+
+struct ItemGroup {
+    Id id;
+    /** Item types the group can yield, nested groups included. */
+    Span<const Item *const> items;
+    /** Probability of each entry of `items`; they sum to 1. */
+    Span<const double> probabilities;
+    AliasTable table;
+
+    /** One weighted item type. */
+    const Item *sample(Rng &rng) const { return items[table.sample(rng)]; }
+};
+
+using ItemGroupTable = ContentTable<ItemGroup>;
+
+/**
+ * Load item groups from a JSON file and compile them against `items`,
+ * which must outlive the returned table. Entries are written one per
+ * line, either as [ "item", weight ] or as an object with "item" or
+ * "group" and an optional "prob" (default 100). Entries naming unknown
+ * items or groups, and nested groups that form a cycle, are reported on
+ * stderr and skipped; groups left without entries are dropped. If the
+ * file cannot be opened, an empty table is returned and an error is
+ * printed to stderr.
+ */
+ItemGroupTable load_item_groups(const std::string &filename, const ItemTable &items);
+
+struct SpawnStats {
+    size_t submaps = 0;
+    size_t items = 0;
+};
+
+/**
+ * Bulk spawn: roll `group` on every tile of the submaps from `first` to
+ * `last` (submap coordinates, inclusive), putting an item on each tile
+ * with probability `density`, and add the items to `map` one batch per
+ * submap, created at turn `turn`. Each submap draws from its own
+ * stream of `seed`, so the result does not depend on the region's shape
+ * or on the order in which regions are spawned. Skips between filled
+ * tiles are drawn from the geometric distribution, so sparse spawns
+ * cost O(items) rather than O(tiles).
+ */
+SpawnStats spawn_item_group(Map &map, const ItemGroup &group, Point first, Point last, double density,
+                            uint64_t turn, uint64_t seed);
@@ -0,0 +1,60 @@
+/*
+ * Minimal job system for the Survival Project.
+ *
+ * A fixed pool of worker threads pulls callables from a shared queue.
+ * submit() returns a std::future for the job's result so callers can
+ * fan work out (for example loading several content files at once) and
+ * join on the results. Every job runs inside a "jobs.run" profile scope
+ * so it shows up in profiler reports and trace timelines.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace jobs {
+
+class Pool {
+public:
+    /** Start `threads` workers; zero selects the hardware concurrency. */
+    explicit Pool(unsigned threads = 0);
+    ~Pool();
+    Pool(const Pool &) = delete;
+    Pool &operator=(const Pool &) = delete;
+
+    /** Queue `fn` for execution and return a future for its result. */
+    template <typename F>
+    auto submit(F &&fn) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(fn));
+        std::future<Result> result = task->get_future();
+        enqueue([task]() { (*task)(); });
+        return result;
+    }
+
+    /** Number of worker threads. */
+    size_t size() const { return workers_.size(); }
+
+private:
+    void enqueue(std::function<void()> job);
+    void worker_loop(unsigned index);
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> queue_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+};
+
+/** Process-wide pool, created on first use. */
+Pool &default_pool();
+
+} // namespace jobs
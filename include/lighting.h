@@ -0,0 +1,136 @@
+/*
+ * Light over the tile map.
+ *
+ * A light source lights the tiles within its radius that it has a line
+ * of sight to, dimming linearly with distance; terrain that blocks light
+ * (see Submap::opaque()) is lit but shades the tiles behind it. Working
+ * that out costs a ray per tile, so each source's contribution is
+ * computed once and cached, cut into one LightGrid per submap its
+ * radius reaches. It is only computed again when the source moves or
+ * changes, or when terrain changes on a tile within its radius.
+ *
+ * The light on a submap is the sum of the cached grids of the sources
+ * reaching it, saturating at 255. A submap's sum is rebuilt only when
+ * one of those grids has changed, so a moving source costs the rays of
+ * that one source plus the sums of the few submaps it touches, however
+ * many other lights there are. Grids are 144 bytes laid out as nine
+ * 16-byte rows, and summing them runs 16 tiles at a time with SSE2.
+ *
+ * Changes are collected and applied together by update(), which the
+ * game calls before light is looked at.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+
+#include "map.h"
+#include "point.h"
+#include "pool.h"
+
+/** Light on each tile of one submap, from 0 (dark) to 255, indexed y * kSubmapSize + x. */
+struct alignas(16) LightGrid {
+    std::array<uint8_t, kSubmapTiles> level{};
+};
+
+/** Add `src` into `dst` tile by tile, saturating at 255. Uses SSE2 where available. */
+void add_light(LightGrid &dst, const LightGrid &src);
+/** Portable version of add_light(), for targets without SSE2 and for comparison. */
+void add_light_scalar(LightGrid &dst, const LightGrid &src);
+
+struct LightSource {
+    /** Tile the light is on. */
+    Point pos;
+    /** Tiles further than this are not lit. */
+    int radius = 0;
+    /** Light on the source's own tile, up to 255. */
+    int brightness = 0;
+};
+
+using LightId = Handle<LightSource>;
+
+class Lighting {
+public:
+    /** Add a light source. It lights the map from the next update(). */
+    LightId add(const LightSource &light);
+    /**
+     * Remove a light source. It stops lighting the map from the next
+     * update(). Returns false if it was already removed.
+     */
+    bool remove(LightId id);
+    /** Move a light source to another tile. */
+    bool move(LightId id, Point pos);
+    /** The source, or nullptr if it was removed. */
+    const LightSource *get(LightId id) const;
+
+    /** Note that terrain changed on `tile`: sources that reach it are recomputed. */
+    void terrain_changed(Point tile);
+
+    /**
+     * Recompute the sources that moved, changed or had terrain change
+     * around them, against the terrain of `map`, and rebuild the grids
+     * of the submaps they reach. Returns the number of sources
+     * recomputed.
+     */
+    size_t update(const Map &map);
+
+    /** Light on a tile, as of the last update(). */
+    uint8_t at(Point tile) const;
+    /** Light on a submap, or nullptr if no source reaches it. */
+    const LightGrid *grid(Point submap) const;
+
+    /** Number of light sources. */
+    size_t size() const { return size_; }
+    /** Heap bytes held for sources, their cached contributions and the submap grids. */
+    size_t bytes_reserved() const;
+
+private:
+    /** A source's contribution to one submap. */
+    struct Block {
+        Point submap;
+        LightGrid light;
+    };
+
+    struct Node {
+        LightSource light;
+        std::vector<Block> blocks;
+        uint32_t generation = 1;
+        bool live = false;
+        bool dirty = false;
+    };
+
+    /** The summed light of one submap and the sources whose radius reaches it. */
+    struct SubmapLight {
+        LightGrid light;
+        std::vector<uint32_t> sources;
+        bool dirty = false;
+    };
+
+    static uint64_t key(Point pos) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(pos.x)) << 32) | static_cast<uint32_t>(pos.y);
+    }
+
+    Node *node(LightId id);
+    void mark_dirty(uint32_t n);
+    /** Take node `n`'s blocks out of the submaps they light, listing those submaps in `dirty_submaps`. */
+    void unlink(uint32_t n, std::pmr::vector<uint64_t> &dirty_submaps);
+    /**
+     * Cast node `n`'s light against `map` and add its blocks to the
+     * submaps they light, listing those submaps in `dirty_submaps`.
+     */
+    void cast(uint32_t n, const Map &map, std::pmr::vector<uint64_t> &dirty_submaps);
+
+    size_t size_ = 0;
+    std::vector<Node> nodes_;
+    // Opacity of the square around the source being cast, reused.
+    std::vector<uint8_t> window_;
+    std::vector<uint32_t> free_;
+    // Nodes added, moved, changed or removed since the last update().
+    std::vector<uint32_t> dirty_;
+    std::unordered_map<uint64_t, SubmapLight> submaps_;
+};
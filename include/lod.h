@@ -0,0 +1,72 @@
+/*
+ * Level-of-detail control for the turn simulation.
+ *
+ * The controller is told what each simulated turn cost and keeps a
+ * moving average of it. While the average runs over the turn budget it
+ * raises the level of detail passed to simulate_turn() one step at a
+ * time, so distant submaps, with their monsters and fields, are updated
+ * less often and caught up in between (see lod_interval() in
+ * simulation.h). Once the average falls well under the budget it lowers
+ * the level again. A level is held for a few turns after each change,
+ * so the average has time to reflect it before the next decision.
+ *
+ * Each coarser level at most halves the cost of the submaps it reaches,
+ * so the level is only lowered below kLowerShare of the budget: going
+ * back down cannot take the turn straight back over it.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "simulation.h"
+
+/** Default turn budget in microseconds. */
+constexpr double kDefaultTurnBudgetUs = 500.0;
+
+class LodController {
+public:
+    /** Share of the budget the average must fall below before the level is lowered. */
+    static constexpr double kLowerShare = 0.4;
+    /** Turns a level is held after it changes. */
+    static constexpr uint64_t kSettleTurns = 8;
+
+    explicit LodController(double budget_us = kDefaultTurnBudgetUs) : budget_us_(budget_us) {}
+
+    /** Level of detail to simulate the next turn at. */
+    int level() const { return level_; }
+
+    /**
+     * Record that a turn simulated at level() took `turn_us`
+     * microseconds, and pick the level for the next one.
+     */
+    void record(double turn_us);
+
+    double budget_us() const { return budget_us_; }
+    void set_budget_us(double budget_us) { budget_us_ = budget_us; }
+
+    /**
+     * Hold the level at `level` regardless of cost. A negative level
+     * returns to automatic control, starting from the current level.
+     */
+    void fix(int level);
+    bool fixed() const { return fixed_; }
+
+    /** Cost of the last turn, and the moving average, in microseconds. */
+    double last_us() const { return last_us_; }
+    double average_us() const { return average_us_; }
+    /** Turns recorded at each level. */
+    uint64_t turns_at(int level) const { return turns_[level]; }
+
+private:
+    double budget_us_;
+    double last_us_ = 0;
+    double average_us_ = 0;
+    int level_ = 0;
+    bool fixed_ = false;
+    uint64_t recorded_ = 0;
+    // Turns recorded since the level last changed.
+    uint64_t held_ = 0;
+    std::array<uint64_t, kMaxLod + 1> turns_{};
+};
@@ -0,0 +1,172 @@
+/*
+ * Tile map for the Survival Project.
+ *
+ * The world is a grid of tiles divided into submaps of 12x12 tiles, as
+ * in CDDA. Submaps are created on demand the first time anything is
+ * generated or placed in them and are addressed by submap coordinates;
+ * tile (x, y) lies in submap (floor(x / 12), floor(y / 12)).
+ *
+ * A submap keeps the items lying on its tiles in one vector grouped by
+ * tile, with an offset table marking where each tile's items start, so
+ * listing a tile is a slice and a freshly generated submap costs two
+ * allocations however many items it holds. Monsters on a submap are
+ * listed by handle; their tile positions live in the instances. Fields
+ * (see field.h) get a layer of their own the first time one appears.
+ */
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "arena.h"
+#include "field.h"
+#include "instances.h"
+#include "point.h"
+
+constexpr int kSubmapSize = 12;
+constexpr int kSubmapTiles = kSubmapSize * kSubmapSize;
+static_assert(FieldLayer::kTiles == kSubmapTiles, "field layers cover one submap");
+
+/** An item to be placed on tile `tile` (y * kSubmapSize + x) of a submap. */
+struct TileItem {
+    uint16_t tile = 0;
+    ItemHandle item;
+};
+
+class Submap {
+public:
+    explicit Submap(Point pos) : pos_(pos) {}
+
+    /** Submap coordinates. */
+    Point pos() const { return pos_; }
+
+    /** Items on the tile at local coordinates (x, y). */
+    Span<const ItemHandle> items_at(int x, int y) const {
+        int t = y * kSubmapSize + x;
+        return Span<const ItemHandle>(items_.data() + item_start_[t], item_start_[t + 1] - item_start_[t]);
+    }
+    /** Every item on the submap, grouped by tile. */
+    Span<const ItemHandle> items() const { return items_; }
+    size_t item_count() const { return items_.size(); }
+
+    /** Put one item on a tile. O(items on the submap). */
+    void add_item(int x, int y, ItemHandle item);
+    /**
+     * Put a batch of items on their tiles in one pass over the submap.
+     * Items keep their batch order within a tile.
+     */
+    void add_items(Span<const TileItem> batch);
+    /**
+     * Drop every item for which `remove(handle)` returns true, in one
+     * pass; the others keep their tiles and order. Returns the number
+     * dropped. The instances are left to the caller.
+     */
+    template <typename F>
+    size_t remove_items_if(F &&remove) {
+        uint32_t kept = 0;
+        uint32_t begin = 0;
+        for (int t = 0; t < kSubmapTiles; ++t) {
+            uint32_t end = item_start_[t + 1];
+            item_start_[t] = kept;
+            for (uint32_t i = begin; i < end; ++i) {
+                if (!remove(items_[i])) items_[kept++] = items_[i];
+            }
+            begin = end;
+        }
+        item_start_[kSubmapTiles] = kept;
+        size_t removed = items_.size() - kept;
+        items_.resize(kept);
+        return removed;
+    }
+
+    /** Monsters whose position lies on this submap. */
+    Span<const MonsterHandle> monsters() const { return monsters_; }
+    void add_monster(MonsterHandle monster);
+    /** Take a monster off the list; the last one takes its place. */
+    bool remove_monster(MonsterHandle monster);
+
+    /** Whether monster spawning has run for this submap. */
+    bool monsters_spawned() const { return monsters_spawned_; }
+    void set_monsters_spawned() { monsters_spawned_ = true; }
+
+    /**
+     * Whether the terrain on the tile at local coordinates (x, y) blocks
+     * light. Walls are the only terrain so far.
+     */
+    bool opaque(int x, int y) const { return opaque_[y * kSubmapSize + x]; }
+    void set_opaque(int x, int y, bool value) { opaque_[y * kSubmapSize + x] = value; }
+
+    /** Fields on the submap, or nullptr if it never had any. */
+    FieldLayer *fields() { return fields_.get(); }
+    const FieldLayer *fields() const { return fields_.get(); }
+    /** Fields on the submap, created empty if needed. */
+    FieldLayer &field_layer();
+
+    /** Turn the submap has been simulated up to (see simulation.h). */
+    uint64_t last_update() const { return last_update_; }
+    void set_last_update(uint64_t turn) { last_update_ = turn; }
+
+    size_t bytes_reserved() const {
+        return sizeof(Submap) + items_.capacity() * sizeof(ItemHandle) + monsters_.capacity() * sizeof(MonsterHandle) +
+               (fields_ ? fields_->bytes_reserved() : 0);
+    }
+
+private:
+    Point pos_;
+    bool monsters_spawned_ = false;
+    uint64_t last_update_ = 0;
+    std::vector<ItemHandle> items_;
+    std::vector<MonsterHandle> monsters_;
+    std::unique_ptr<FieldLayer> fields_;
+    std::bitset<kSubmapTiles> opaque_;
+    // Items of tile t are items_[item_start_[t], item_start_[t + 1]).
+    std::array<uint32_t, kSubmapTiles + 1> item_start_{};
+};
+
+class Map {
+public:
+    /** Submap at submap coordinates `pos`, or nullptr if it was never created. */
+    Submap *find(Point pos);
+    const Submap *find(Point pos) const;
+    /** Submap at `pos`, created empty if needed. */
+    Submap &submap(Point pos);
+
+    size_t size() const { return submaps_.size(); }
+    /** Items on all submaps. */
+    size_t item_count() const;
+    /** Monsters on all submaps. */
+    size_t monster_count() const;
+
+    /** Call `f(submap)` for every submap, in no particular order. */
+    template <typename F>
+    void for_each(F &&f) const {
+        for (const auto &entry : submaps_) f(*entry.second);
+    }
+
+    /** Heap bytes held for submaps and their item lists. */
+    size_t bytes_reserved() const;
+
+private:
+    static uint64_t key(Point pos) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(pos.x)) << 32) | static_cast<uint32_t>(pos.y);
+    }
+
+    // Submaps are boxed so that pointers to them survive rehashing.
+    std::unordered_map<uint64_t, std::unique_ptr<Submap>> submaps_;
+};
+
+/** Submap containing tile `tile`. */
+inline Point submap_of(Point tile) {
+    auto floor_div = [](int a) { return a >= 0 ? a / kSubmapSize : (a - kSubmapSize + 1) / kSubmapSize; };
+    return Point{floor_div(tile.x), floor_div(tile.y)};
+}
+
+inline Footprint footprint(const Map &map) {
+    return Footprint{map.bytes_reserved(), 0};
+}
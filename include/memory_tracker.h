@@ -0,0 +1,88 @@
+/*
+ * Allocation tracking and per-subsystem memory accounting.
+ *
+ * When SURVIVAL_MEMORY_TRACKING is enabled (the default, see
+ * CMakeLists.txt) the global operator new/delete are replaced with
+ * versions that prefix each block with a small header recording its
+ * size and the subsystem tag that was active when it was allocated.
+ * Code marks the subsystem it is working for with a TagScope:
+ *
+ *     memory::TagScope tag(memory::Tag::inventory);
+ *     inventory.push_back(item);
+ *
+ * Counters are relaxed atomics per tag, so the overhead is a header
+ * and a few uncontended atomic adds per allocation. Frees are charged
+ * to the tag that made the allocation, keeping live byte counts exact
+ * even when memory changes hands between subsystems.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+namespace memory {
+
+enum class Tag : uint8_t {
+    other,
+    content,
+    world,
+    inventory,
+    diagnostics,
+    frame,
+    count
+};
+
+/** Human-readable name of a tag. */
+const char *tag_name(Tag tag);
+
+/** Snapshot of the counters for one tag. */
+struct TagStats {
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t live_bytes = 0;
+    uint64_t peak_bytes = 0;
+};
+
+/** Whether allocation tracking was compiled in. */
+bool tracking_enabled();
+
+/** Current counters for `tag`; all zero when tracking is disabled. */
+TagStats stats(Tag tag);
+
+/** Tag charged for allocations made by the calling thread. */
+Tag current_tag();
+
+/** Set the calling thread's tag for the lifetime of the scope. */
+class TagScope {
+public:
+    explicit TagScope(Tag tag);
+    ~TagScope();
+    TagScope(const TagScope &) = delete;
+    TagScope &operator=(const TagScope &) = delete;
+
+private:
+    Tag previous_;
+};
+
+/**
+ * Resident set size of the process in bytes, current and peak. Zero
+ * where the platform does not expose it.
+ */
+struct ProcessMemory {
+    uint64_t rss_bytes = 0;
+    uint64_t peak_rss_bytes = 0;
+};
+ProcessMemory process_memory();
+
+/** Write a per-tag table of the allocation counters and process RSS. */
+void write_report(std::ostream &out);
+
+/**
+ * Publish allocation counters as metrics gauges. Registered as a
+ * metrics collector by the first call; safe to call repeatedly.
+ */
+void register_metrics();
+
+} // namespace memory
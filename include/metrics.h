@@ -0,0 +1,160 @@
+/*
+ * Runtime metrics for the Survival Project.
+ *
+ * Counters, gauges and latency histograms live in a process-wide
+ * registry and are exported in the Prometheus text exposition format,
+ * either on demand (the `metrics` command) or periodically to a file
+ * when the game is started with --metrics-file=<path>.
+ *
+ * Hot-path updates are lock-free: counters are sharded across
+ * cache-line-padded slots chosen per thread, and histograms use
+ * log-linear (HDR-style) buckets with relaxed atomic counts. Look a
+ * metric up once and keep the reference:
+ *
+ *     static metrics::Counter &loaded = metrics::counter("items_loaded_total", "...");
+ *     loaded.add(items.size());
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+namespace metrics {
+
+namespace detail {
+constexpr size_t kShards = 16;
+/** Shard index of the calling thread. */
+size_t thread_shard();
+} // namespace detail
+
+/** Monotonically increasing count. */
+class Counter {
+public:
+    void add(uint64_t n = 1) {
+        shards_[detail::thread_shard()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+    uint64_t value() const;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+    Shard shards_[detail::kShards];
+};
+
+/** Value that can go up and down, such as a current size. */
+class Gauge {
+public:
+    void set(int64_t v) { value_.store(v, std::memory_order_relaxed); }
+    void add(int64_t n) { value_.fetch_add(n, std::memory_order_relaxed); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+/**
+ * Log-linear histogram of non-negative integer samples (nanoseconds for
+ * latencies). Each power of two is split into kSubBuckets linear
+ * buckets, giving a relative error of at most 1/kSubBuckets.
+ */
+class Histogram {
+public:
+    static constexpr unsigned kSubBits = 4;
+    static constexpr unsigned kSubBuckets = 1u << kSubBits;
+    static constexpr unsigned kBuckets = (64 - kSubBits + 1) * kSubBuckets;
+
+    void record(uint64_t value);
+    void record(std::chrono::steady_clock::duration d) {
+        record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count()));
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+    /** Value at quantile q in [0, 1], accurate to the bucket width. */
+    uint64_t quantile(double q) const;
+
+    static unsigned bucket_index(uint64_t value);
+    static uint64_t bucket_upper_bound(unsigned index);
+
+private:
+    std::atomic<uint64_t> buckets_[kBuckets] = {};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+/**
+ * RAII timer recording the lifetime of the scope into a histogram.
+ */
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram &histogram)
+        : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() { histogram_.record(std::chrono::steady_clock::now() - start_); }
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+private:
+    Histogram &histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * Find or create a metric by name. References stay valid for the life
+ * of the program. Histogram samples are exported in seconds when
+ * `nanoseconds` is true, otherwise as raw values.
+ */
+Counter &counter(const std::string &name, const std::string &help);
+Gauge &gauge(const std::string &name, const std::string &help);
+Histogram &histogram(const std::string &name, const std::string &help, bool nanoseconds = true);
+
+/**
+ * Register a callback run before every export, letting other
+ * subsystems refresh gauges that are cheaper to read on demand than to
+ * maintain on every change.
+ */
+void add_collector(std::function<void()> collector);
+
+/** Write every registered metric in Prometheus text format. */
+void write_prometheus(std::ostream &out);
+
+/**
+ * Write the metrics to `path` atomically (via a temporary file and
+ * rename) so readers never observe a partial dump.
+ */
+bool write_prometheus_file(const std::string &path);
+
+/**
+ * Background thread that dumps the registry to a file every
+ * `interval`, plus once more when stopped.
+ */
+class FileDumper {
+public:
+    FileDumper(std::string path, std::chrono::milliseconds interval);
+    ~FileDumper();
+    FileDumper(const FileDumper &) = delete;
+    FileDumper &operator=(const FileDumper &) = delete;
+
+private:
+    void run();
+
+    std::string path_;
+    std::chrono::milliseconds interval_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+} // namespace metrics
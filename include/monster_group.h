@@ -0,0 +1,96 @@
+/*
+ * Monster groups and density-controlled monster spawning.
+ *
+ * A monster group lists monster types with relative weights and the
+ * size of the packs they roam in, CDDA-style:
+ *
+ *     {
+ *       "type": "monstergroup",
+ *       "id": "GROUP_FOREST",
+ *       "monsters": [
+ *         { "monster": "mon_wolf", "weight": 30, "pack_size": [ 2, 5 ] },
+ *         { "monster": "mon_bear", "weight": 5 }
+ *       ]
+ *     }
+ *
+ * Groups are compiled into alias tables at load time, like item groups.
+ *
+ * The spawner places packs over a whole region of submaps in one batch.
+ * Pack centres are spaced by dart throwing with a minimum distance
+ * (a Poisson-disk / blue-noise pattern), checked against a background
+ * grid whose cells are small enough to hold one centre each, so every
+ * candidate costs a handful of cell reads. The minimum distance holds
+ * across submap borders within the region and against monsters that
+ * earlier batches left in neighbouring submaps.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "alias_table.h"
+#include "content.h"
+#include "id.h"
+#include "map.h"
+#include "rng.h"
+
+/** Largest pack a group entry may spawn; entries asking for more are skipped. */
+constexpr int kMaxPackSize = 100;
+
+/** Inclusive range of monsters spawned together. */
+struct PackSize {
+    int min = 1;
+    int max = 1;
+};
+
+struct MonsterGroup {
+    Id id;
+    Span<const Monster *const> monsters;
+    Span<const PackSize> packs;
+    /** Probability of each entry; they sum to 1. */
+    Span<const double> probabilities;
+    AliasTable table;
+
+    /** Index of one weighted entry. */
+    uint32_t sample(Rng &rng) const { return table.sample(rng); }
+};
+
+using MonsterGroupTable = ContentTable<MonsterGroup>;
+
+/**
+ * Load monster groups from a JSON file and compile them against
+ * `monsters`, which must outlive the returned table. Each entry is
+ * written on one line with "monster", "weight" (or CDDA's "freq";
+ * default 100) and an optional "pack_size" of [ min, max ]. Entries
+ * naming unknown monsters are reported on stderr and skipped; groups
+ * left without entries are dropped. If the file cannot be opened, an
+ * empty table is returned and an error is printed to stderr.
+ */
+MonsterGroupTable load_monster_groups(const std::string &filename, const MonsterTable &monsters);
+
+struct MonsterSpawnOptions {
+    /** Expected number of packs per submap. */
+    double packs_per_submap = 0.5;
+    /** Minimum distance in tiles between pack centres. */
+    int min_distance = 8;
+    /** Placement attempts per pack before it is dropped. */
+    int attempts = 30;
+};
+
+struct MonsterSpawnStats {
+    size_t submaps = 0;
+    size_t packs = 0;
+    size_t monsters = 0;
+};
+
+/**
+ * Spawn packs from `group` on the submaps from `first` to `last`
+ * (submap coordinates, inclusive) that have not had monsters spawned
+ * yet, then mark them spawned. Pack members stand on or next to their
+ * pack's centre, inside its submap, as of turn `turn`. Each submap
+ * draws from its own stream of `seed`, so for a given seed and sequence
+ * of calls the placement is always the same.
+ */
+MonsterSpawnStats spawn_monster_group(Map &map, const MonsterGroup &group, Point first, Point last,
+                                      const MonsterSpawnOptions &options, uint64_t turn, uint64_t seed);
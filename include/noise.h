@@ -0,0 +1,48 @@
+/*
+ * Gradient noise for world generation.
+ *
+ * Fractal gradient (Perlin-style) noise over the integer grid: each
+ * lattice point gets one of four diagonal gradients from an integer
+ * hash of its coordinates and the seed, samples blend the four corners
+ * of their cell with the quintic fade curve, and octaves of rising
+ * frequency and falling amplitude are summed.
+ *
+ * Rows of samples are evaluated 8 at a time with AVX2 or 4 at a time
+ * with SSE2, picked at run time from what the CPU supports, with a
+ * scalar loop elsewhere and for the leftover samples. Every path does
+ * the same 32-bit float operations in the same order (the hash is
+ * integer arithmetic, floor is computed the same way everywhere, and
+ * nothing is fused), so a seed gives bit-identical terrain on every
+ * machine and path.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/** Instruction set a noise row is evaluated with. */
+enum class SimdPath : uint8_t { scalar, sse2, avx2 };
+
+/** Widest path the running CPU supports. */
+SimdPath best_simd_path();
+const char *simd_path_name(SimdPath path);
+
+struct NoiseParams {
+    uint32_t seed = 0;
+    /** Lattice cells per sample unit of the first octave. */
+    float frequency = 1.0f / 16;
+    int octaves = 4;
+    /** Frequency multiplier from one octave to the next. */
+    float lacunarity = 2.0f;
+    /** Amplitude multiplier from one octave to the next. */
+    float gain = 0.5f;
+};
+
+/**
+ * Noise at the integer points (x0 + i, y) for i in [0, count), written
+ * to out[i]. Values lie roughly in [-1, 1] per octave's amplitude.
+ * Uses best_simd_path(), or `path` when given; a path the CPU does not
+ * support falls back to the next narrower one.
+ */
+void noise_row(const NoiseParams &params, int x0, int y, int count, float *out);
+void noise_row(const NoiseParams &params, int x0, int y, int count, float *out, SimdPath path);
@@ -0,0 +1,89 @@
+/*
+ * The overmap: the world at the scale of whole city blocks and woods.
+ *
+ * Each overmap tile (OMT) covers 2x2 submaps, and overmaps of 180x180
+ * tiles are generated on demand, as in CDDA. An overmap tile is a city,
+ * forest or open field, placed by two layers of gradient noise (see
+ * noise.h) sampled at global tile coordinates, so overmaps join up
+ * seamlessly and a seed always lays out the same world: low-frequency
+ * noise marks where cities sprawl, and a finer layer scatters woods
+ * over the land between them.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "noise.h"
+#include "point.h"
+
+constexpr int kOvermapSize = 180;
+constexpr int kOvermapTiles = kOvermapSize * kOvermapSize;
+/** Submaps along each side of an overmap tile. */
+constexpr int kSubmapsPerOmt = 2;
+
+enum class OvermapTerrain : uint8_t { field, forest, city };
+
+constexpr int kOvermapTerrains = 3;
+
+const char *terrain_name(OvermapTerrain terrain);
+char terrain_glyph(OvermapTerrain terrain);
+
+/** Overmap tile containing submap `submap`. */
+inline Point omt_of(Point submap) {
+    auto floor_div = [](int a) { return a >= 0 ? a / kSubmapsPerOmt : (a - kSubmapsPerOmt + 1) / kSubmapsPerOmt; };
+    return Point{floor_div(submap.x), floor_div(submap.y)};
+}
+
+/** Overmap containing overmap tile `omt`. */
+inline Point overmap_of(Point omt) {
+    auto floor_div = [](int a) { return a >= 0 ? a / kOvermapSize : (a - kOvermapSize + 1) / kOvermapSize; };
+    return Point{floor_div(omt.x), floor_div(omt.y)};
+}
+
+class Overmap {
+public:
+    /** Generate overmap `pos` (in overmap coordinates) of the world `seed`, with the given noise path. */
+    Overmap(Point pos, uint32_t seed, SimdPath path = best_simd_path());
+
+    Point pos() const { return pos_; }
+
+    /** Terrain at local overmap tile coordinates (x, y). */
+    OvermapTerrain terrain(int x, int y) const { return terrain_[y * kOvermapSize + x]; }
+    /** Number of tiles of each terrain. */
+    size_t count(OvermapTerrain terrain) const { return counts_[static_cast<int>(terrain)]; }
+
+    size_t bytes_reserved() const { return terrain_.capacity() * sizeof(OvermapTerrain); }
+
+private:
+    Point pos_;
+    std::vector<OvermapTerrain> terrain_;
+    std::array<size_t, kOvermapTerrains> counts_{};
+};
+
+/** The overmaps generated so far, keyed by overmap coordinates. */
+class OvermapBuffer {
+public:
+    explicit OvermapBuffer(uint32_t seed) : seed_(seed) {}
+
+    /** Overmap `pos`, generated on first use. */
+    const Overmap &get(Point pos);
+    /** Terrain of global overmap tile `omt`, generating its overmap if needed. */
+    OvermapTerrain terrain(Point omt);
+
+    size_t size() const { return overmaps_.size(); }
+    size_t bytes_reserved() const;
+
+private:
+    static uint64_t key(Point pos) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(pos.x)) << 32) | static_cast<uint32_t>(pos.y);
+    }
+
+    uint32_t seed_;
+    std::unordered_map<uint64_t, std::unique_ptr<Overmap>> overmaps_;
+};
@@ -0,0 +1,86 @@
+/*
+ * Player state for the Survival Project.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "id.h"
+#include "instances.h"
+#include "inventory.h"
+#include "point.h"
+
+/**
+ * Simple Player structure that holds a nested inventory of item
+ * handles. The player can pick up items from the world and drop them
+ * back; the items themselves stay in item_pool() throughout.
+ *
+ * The inventory root carries the player's limits, and the inventory
+ * keeps weight and volume totals up to date on every change, so
+ * checking whether another item fits never sums the inventory.
+ */
+struct Player {
+    /** Carrying limits in grams and millilitres. */
+    static constexpr int64_t kWeightCapacity = 40000;
+    static constexpr int64_t kVolumeCapacity = 20000;
+
+    Inventory inventory{kWeightCapacity, kVolumeCapacity};
+
+    /**
+     * Hit points representing the player's health in combat. The player
+     * starts with 100 hp and loses hp when taking damage from monsters.
+     */
+    int hp = 100;
+
+    /** Tile the player stands on; the active area is centred on its submap. */
+    Point pos;
+
+    /** Total weight carried, including the contents of containers. */
+    int64_t carried_weight() const { return inventory.weight(Inventory::kRoot); }
+    /** Volume of the items carried directly, not inside containers. */
+    int64_t carried_volume() const { return inventory.contained_volume(Inventory::kRoot); }
+
+    /**
+     * Whether an item of the given type fits somewhere in the
+     * inventory. The top level is checked first, in O(1).
+     */
+    bool can_carry(const Item &type) const {
+        return inventory.fits(type, Inventory::kRoot) || inventory.find_space(type) != Inventory::kNone;
+    }
+
+    /**
+     * Add an item to the player's inventory, in the first container
+     * pocket with room for it or else at the top level. Limits are not
+     * enforced here; callers check can_carry() where refusing makes
+     * sense.
+     */
+    void add_item(ItemHandle item) {
+        Inventory::NodeId pocket = Inventory::kRoot;
+        if (const Item *type = item_type(item)) {
+            pocket = inventory.find_space(*type);
+        }
+        inventory.insert(item, pocket == Inventory::kNone ? Inventory::kRoot : pocket);
+    }
+
+    /**
+     * Remove an item by id from the player's inventory.
+     * Returns true if removed, false if not found. If the item is a
+     * container, the items inside it are appended to `contents`, or
+     * put back into the inventory when `contents` is null.
+     */
+    bool remove_item(const Id &item_id, ItemHandle &out_item, std::vector<ItemHandle> *contents = nullptr) {
+        Inventory::NodeId found = inventory.find(item_id);
+        if (found == Inventory::kNone) {
+            return false;
+        }
+        out_item = inventory.item(found);
+        std::vector<ItemHandle> inside;
+        inventory.remove(found, contents ? *contents : inside);
+        for (ItemHandle h : inside) {
+            add_item(h);
+        }
+        return true;
+    }
+};
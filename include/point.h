@@ -0,0 +1,13 @@
+/*
+ * 2D integer positions on the world grid.
+ */
+
+#pragma once
+
+/** A position in tiles or in submaps, depending on context. */
+struct Point {
+    int x = 0;
+    int y = 0;
+    bool operator==(const Point &o) const { return x == o.x && y == o.y; }
+    bool operator!=(const Point &o) const { return !(*this == o); }
+};
@@ -0,0 +1,147 @@
+/*
+ * Object pools addressed by generational handles.
+ *
+ * A Pool<T> stores objects in fixed-size chunks of slots that are never
+ * moved or returned to the heap while the pool lives. Destroyed slots
+ * go on a free list and are reused by the next create(), so objects
+ * that come and go (item instances, monsters in a fight) recycle the
+ * same memory instead of fragmenting the heap.
+ *
+ * Objects are referred to by Handle<T>, a slot index paired with the
+ * generation the slot had when the object was created. Destroying an
+ * object bumps its slot's generation, so any handle still referring
+ * to it is detected as stale: get() returns nullptr instead of a
+ * pointer to whatever reuses the slot. Handles are two words and
+ * trivially copyable, so moving an object between containers is a
+ * handle transfer.
+ *
+ * Pools are not thread-safe; each one belongs to the thread that owns
+ * the simulation state it holds.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+template <typename T>
+struct Handle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    /** False for default-constructed handles. Says nothing about staleness. */
+    bool valid() const { return index != UINT32_MAX; }
+    bool operator==(const Handle &o) const { return index == o.index && generation == o.generation; }
+    bool operator!=(const Handle &o) const { return !(*this == o); }
+};
+
+template <typename T>
+class Pool {
+public:
+    static constexpr size_t kChunkSlots = 1024;
+
+    Pool() = default;
+    Pool(const Pool &) = delete;
+    Pool &operator=(const Pool &) = delete;
+    ~Pool() { clear(); }
+
+    /** Construct an object in a free slot and return its handle. */
+    template <typename... Args>
+    Handle<T> create(Args &&...args) {
+        if (free_head_ == kNoSlot) {
+            add_chunk();
+        }
+        uint32_t index = free_head_;
+        Slot &s = slot(index);
+        free_head_ = s.next_free;
+        new (s.storage) T(std::forward<Args>(args)...);
+        s.live = true;
+        ++live_;
+        return Handle<T>{index, s.generation};
+    }
+
+    /** The object a handle refers to, or nullptr if it was destroyed. */
+    T *get(Handle<T> h) {
+        if (h.index >= slot_count_) return nullptr;
+        Slot &s = slot(h.index);
+        return s.live && s.generation == h.generation ? s.object() : nullptr;
+    }
+    const T *get(Handle<T> h) const { return const_cast<Pool *>(this)->get(h); }
+
+    /**
+     * Destroy the object a handle refers to. Returns false (and does
+     * nothing) if the handle is already stale.
+     */
+    bool destroy(Handle<T> h) {
+        T *obj = get(h);
+        if (!obj) return false;
+        obj->~T();
+        Slot &s = slot(h.index);
+        s.live = false;
+        ++s.generation;
+        s.next_free = free_head_;
+        free_head_ = h.index;
+        --live_;
+        return true;
+    }
+
+    /** Destroy every object. Outstanding handles all become stale. */
+    void clear() {
+        for (uint32_t i = 0; i < slot_count_; ++i) {
+            Slot &s = slot(i);
+            if (s.live) destroy(Handle<T>{i, s.generation});
+        }
+    }
+
+    /** Number of live objects. */
+    size_t size() const { return live_; }
+    /** Number of slots allocated, live or free. */
+    size_t capacity() const { return slot_count_; }
+    /** Heap bytes held for slots. */
+    size_t bytes_reserved() const { return chunks_.size() * kChunkSlots * sizeof(Slot); }
+
+    /** Call `f(handle, object)` for every live object in slot order. */
+    template <typename F>
+    void for_each(F &&f) {
+        for (uint32_t i = 0; i < slot_count_; ++i) {
+            Slot &s = slot(i);
+            if (s.live) f(Handle<T>{i, s.generation}, *s.object());
+        }
+    }
+
+private:
+    static constexpr uint32_t kNoSlot = UINT32_MAX;
+
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)];
+        // Generations start at 1 so that a zeroed handle never matches.
+        uint32_t generation = 1;
+        uint32_t next_free = kNoSlot;
+        bool live = false;
+
+        T *object() { return std::launder(reinterpret_cast<T *>(storage)); }
+    };
+
+    Slot &slot(uint32_t index) { return chunks_[index / kChunkSlots][index % kChunkSlots]; }
+
+    void add_chunk() {
+        chunks_.push_back(std::make_unique<Slot[]>(kChunkSlots));
+        uint32_t first = slot_count_;
+        slot_count_ += kChunkSlots;
+        // Thread the new slots onto the free list in ascending order so
+        // that fresh objects are laid out in creation order.
+        for (uint32_t i = slot_count_; i-- > first;) {
+            slot(i).next_free = free_head_;
+            free_head_ = i;
+        }
+    }
+
+    std::vector<std::unique_ptr<Slot[]>> chunks_;
+    uint32_t slot_count_ = 0;
+    uint32_t free_head_ = kNoSlot;
+    size_t live_ = 0;
+};
@@ -0,0 +1,78 @@
+/*
+ * Lightweight scoped profiler for the Survival Project.
+ *
+ * Code marks interesting regions with PROFILE_SCOPE("name"). Each scope
+ * measures its wall time with std::chrono::steady_clock and folds the
+ * sample into a per-thread table, so the hot path never takes a lock.
+ * The tables are registered once per thread and merged by name when a
+ * report is requested, either through the in-game `profile` command or
+ * at exit when the binary is started with --profile-report.
+ *
+ * When event tracing is enabled (see trace.h) each scope is also
+ * recorded as a span on the thread's trace timeline.
+ *
+ * Scope names must be string literals (or otherwise outlive the
+ * program); the profiler stores the pointer, not a copy.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+#include "trace.h"
+
+namespace profiler {
+
+/**
+ * Record a single sample of `ns` nanoseconds under `name` in the
+ * calling thread's table.
+ */
+void record(const char *name, uint64_t ns);
+
+/**
+ * Write aggregated timings for every scope seen on any thread, sorted
+ * by total time, to the given stream.
+ */
+void write_report(std::ostream &out);
+
+/**
+ * Clear all collected samples. Intended for use between measurements
+ * from the main thread; samples recorded concurrently may be lost.
+ */
+void reset();
+
+/**
+ * RAII timing scope. Construction captures the start time and
+ * destruction records the elapsed time under the scope's name.
+ */
+class Scope {
+public:
+    explicit Scope(const char *name)
+        : name_(name), start_(std::chrono::steady_clock::now()) {}
+    ~Scope() {
+        auto end = std::chrono::steady_clock::now();
+        record(name_, static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start_).count()));
+        if (trace::is_enabled()) {
+            trace::record_span(name_, start_, end);
+        }
+    }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+private:
+    const char *name_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace profiler
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+/**
+ * Time the enclosing block under `name`.
+ */
+#define PROFILE_SCOPE(name) ::profiler::Scope PROFILE_CONCAT(profile_scope_, __LINE__)(name)
@@ -0,0 +1,75 @@
+/*
+ * Fast deterministic random numbers for world generation.
+ *
+ * Rng is xoshiro256** seeded through splitmix64: a few instructions per
+ * 64-bit draw and the same sequence on every platform, which
+ * std::uniform_*_distribution does not guarantee. World generation
+ * derives one stream per submap from the world seed and the submap's
+ * coordinates (see stream_seed()), so the content of a submap does not
+ * depend on the order in which submaps are generated or on how a
+ * region is split into batches.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+class Rng {
+public:
+    using result_type = uint64_t;
+
+    explicit Rng(uint64_t seed = 1) {
+        for (uint64_t &word : s_) word = splitmix64(seed);
+    }
+
+    uint64_t next() {
+        uint64_t result = rotl(s_[1] * 5, 7) * 9;
+        uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+    }
+
+    /** Uniform double in [0, 1). */
+    double uniform() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+
+    /** Uniform integer in [0, n), without division. */
+    uint32_t below(uint32_t n) { return static_cast<uint32_t>(((next() >> 32) * n) >> 32); }
+
+    /** Standard normal variate, by Box-Muller (the sine half is discarded). */
+    double normal() {
+        double r = std::sqrt(-2.0 * std::log(1.0 - uniform()));
+        return r * std::cos(6.283185307179586 * uniform());
+    }
+
+    /** Lets Rng drive standard algorithms such as std::shuffle. */
+    uint64_t operator()() { return next(); }
+    static constexpr uint64_t min() { return 0; }
+    static constexpr uint64_t max() { return UINT64_MAX; }
+
+    /** Advance `state` and return the next splitmix64 output. */
+    static uint64_t splitmix64(uint64_t &state) {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    /** Seed of an independent stream keyed by a world seed and a 2D position. */
+    static uint64_t stream_seed(uint64_t seed, int32_t x, int32_t y) {
+        uint64_t state = seed;
+        uint64_t a = splitmix64(state) ^ static_cast<uint32_t>(x);
+        uint64_t b = splitmix64(a) ^ (static_cast<uint64_t>(static_cast<uint32_t>(y)) << 32);
+        return splitmix64(b);
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    uint64_t s_[4];
+};
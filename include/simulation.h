@@ -0,0 +1,134 @@
+/*
+ * Turn-by-turn simulation of the tile map.
+ *
+ * Only the active area, the submaps within kActiveRadius of the
+ * player's, is simulated turn by turn. The rest of the map is dormant:
+ * each submap records the turn it was last brought up to date, and when
+ * it comes back into the active area it is fast-forwarded over the
+ * elapsed turns in one step, using closed-form results for what would
+ * have happened instead of replaying the turns. A turn therefore costs
+ * the same however large the map has grown.
+ *
+ * What changes on a submap over time:
+ *
+ *  - Monsters wander. Each turn a monster takes a step to a random
+ *    neighbouring tile with probability speed / 100 (capped at 1). Over
+ *    n turns that walk spreads out as a normal distribution with
+ *    variance 0.75 * p * n per axis, so a catch-up draws one
+ *    displacement per monster; catch-ups of a few turns replay the
+ *    steps instead, which is cheaper. Monsters cross into neighbouring
+ *    submaps that exist, and stop at the edge of those that do not.
+ *  - Items rot. Rot itself is never ticked (see instances.h); perishable
+ *    items that have lain rotten for another shelf life rot away and are
+ *    removed at hourly sweeps, run on the active area and on catch-ups
+ *    that span the turn of one.
+ *  - Fields spread and decay, over each submap's active field tiles
+ *    only (see field.h). Burning tiles may set their unburnt neighbours
+ *    alight and give off smoke; smoke and gas drift. Over a catch-up,
+ *    fields only decay: each intensity level lasts a geometric number of
+ *    turns, drawn directly, and nothing spreads while a submap is
+ *    dormant.
+ *
+ * When turns run over budget (see lod.h), the active area is simulated
+ * at a coarser level of detail: submaps further out are updated only
+ * every few turns, and caught up on the turns they are, the same way as
+ * dormant ones. The player's own submap is always simulated every turn.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "field.h"
+#include "map.h"
+#include "point.h"
+
+/** Submaps within this many submaps of the player's are simulated every turn. */
+constexpr int kActiveRadius = 2;
+
+/** Coarsest level of detail; level 0 simulates every active submap every turn. */
+constexpr int kMaxLod = 3;
+
+/**
+ * Turns between updates, at level of detail `lod`, of the submaps
+ * `ring` submaps (Chebyshev distance) from the centre of an active area
+ * of `radius`. The area is split into kMaxLod bands by distance, and
+ * each level doubles the interval of every band it reaches, outermost
+ * first: at kMaxLod the outer band is updated every 8 turns, the middle
+ * one every 4 and the inner one every 2.
+ */
+inline uint64_t lod_interval(int ring, int radius, int lod) {
+    if (ring <= 0 || radius <= 0) return 1;
+    int band = (ring * kMaxLod + radius - 1) / radius;
+    int shift = lod - (kMaxLod - band);
+    return shift > 0 ? uint64_t{1} << shift : 1;
+}
+
+/** Share of its shelf life after which a perishable item lying in the world rots away. */
+constexpr double kRotAway = 2.0;
+
+struct TurnStats {
+    /** Submaps simulated. */
+    size_t submaps = 0;
+    /** Of those, submaps that were dormant and were caught up first. */
+    size_t caught_up = 0;
+    size_t monsters = 0;
+    /** Items that rotted away. */
+    size_t items_removed = 0;
+    /** Active field tiles processed. */
+    size_t field_tiles = 0;
+    /** Positions in the active area left for a later turn by the level of detail, submap or not. */
+    size_t deferred = 0;
+
+    TurnStats &operator+=(const TurnStats &o) {
+        submaps += o.submaps;
+        caught_up += o.caught_up;
+        monsters += o.monsters;
+        items_removed += o.items_removed;
+        field_tiles += o.field_tiles;
+        deferred += o.deferred;
+        return *this;
+    }
+};
+
+/**
+ * Bring `submap` from its last update to turn `now` in one step, as if
+ * it had been simulated all along. Draws from a stream of `seed` keyed
+ * by the submap and `now`, so a catch-up is reproducible.
+ */
+TurnStats catch_up(Map &map, Submap &submap, uint64_t now, uint64_t seed);
+
+/**
+ * Simulate turn `turn` on the submaps within `radius` of `center`
+ * (submap coordinates), catching up those that missed earlier turns
+ * first. Submaps outside the area are not touched. At level of detail
+ * `lod`, submaps whose lod_interval() is above 1 are only simulated on
+ * every so many turns, staggered by position so that a ring's work is
+ * spread over the turns rather than landing on the same one.
+ */
+TurnStats simulate_turn(Map &map, Point center, int radius, uint64_t turn, uint64_t seed, int lod = 0);
+
+/**
+ * Distance in tiles (the larger of the x and y distances, which is the
+ * number of steps) from `tile` to the nearest monster on the submaps
+ * within `radius` of its submap, or -1 if there is none. Monsters take
+ * at most one step a turn, so none can get closer than this minus the
+ * turns that pass.
+ */
+int nearest_monster(const Map &map, Point tile, int radius);
+
+/**
+ * Whether the submaps within `radius` of `center` (submap coordinates)
+ * hold no monsters and no fields, so that simulating turns there
+ * changes nothing a catch-up would not.
+ */
+bool area_is_quiet(const Map &map, Point center, int radius);
+
+/**
+ * Put a field of the given intensity on tile `tile` at turn `now`,
+ * creating its submap if needed. The submap is caught up to `now`
+ * first, so the field does not decay over turns before it existed.
+ * Fire only catches on tiles that have not burnt yet.
+ */
+void place_field(Map &map, Point tile, FieldType type, int intensity, uint64_t now, uint64_t seed);
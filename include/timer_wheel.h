@@ -0,0 +1,132 @@
+/*
+ * Hierarchical timing wheel for "run at turn T" events.
+ *
+ * Timers are kept in four wheels of 256 slots. Wheel 0 holds timers
+ * due within the current block of 256 turns, one slot per turn; wheel
+ * 1 holds those due within the current block of 65536 turns, one slot
+ * per 256 turns; and so on up to 2^32 turns ahead. Each slot is an
+ * intrusive doubly-linked list threaded through a flat vector of timer
+ * nodes, so scheduling and cancelling are O(1). Advancing one turn
+ * fires wheel 0's slot for that turn; at each block boundary the next
+ * slot of the wheel above is redistributed into the wheels below,
+ * which moves every timer at most three times over its life, so expiry
+ * costs amortized O(1) per timer instead of a scan over every entity
+ * every turn. Stretches of turns with nothing due are skipped whole.
+ *
+ * A timer carries an event: a kind, chosen by the subsystem that
+ * scheduled it, and 64 bits of data (typically a handle or an index).
+ * Timers are addressed by generational handles, so cancelling a timer
+ * that already fired is detected and harmless.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "pool.h"
+
+struct TimerEvent {
+    uint32_t kind = 0;
+    uint64_t data = 0;
+};
+
+using TimerId = Handle<TimerEvent>;
+
+class TimerWheel {
+public:
+    explicit TimerWheel(uint64_t now = 0) : now_(now) { heads_.fill(kNone); }
+
+    /** The last turn advanced to. */
+    uint64_t now() const { return now_; }
+
+    /**
+     * Schedule `event` to fire at `turn`. Turns at or before now() fire
+     * on the next advance; turns more than 2^32 ahead are brought in to
+     * 2^32 - 1 turns ahead.
+     */
+    TimerId schedule(uint64_t turn, TimerEvent event);
+
+    /** Cancel a pending timer. Returns false if it already fired or was cancelled. */
+    bool cancel(TimerId id);
+
+    /** Whether a timer is still waiting to fire. */
+    bool pending(TimerId id) const {
+        return id.index < nodes_.size() && nodes_[id.index].generation == id.generation &&
+               nodes_[id.index].slot != kFree;
+    }
+    /** Turn a pending timer fires at. */
+    uint64_t deadline(TimerId id) const { return nodes_[id.index].deadline; }
+
+    /** Number of pending timers. */
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    /**
+     * Advance to `turn`, calling `fire(id, event)` for every timer due
+     * at or before it, turn by turn; timers due on the same turn fire in
+     * no particular order. `fire` may schedule and cancel timers; new
+     * timers due before `turn` fire during this call. Returns the
+     * number of timers fired.
+     */
+    template <typename F>
+    size_t advance(uint64_t turn, F &&fire) {
+        size_t fired = 0;
+        while (now_ < turn) {
+            step_to(turn);
+            uint32_t slot = static_cast<uint32_t>(now_ & kSlotMask);
+            while (heads_[slot] != kNone) {
+                uint32_t n = heads_[slot];
+                unlink(n);
+                TimerEvent event = nodes_[n].event;
+                TimerId id{n, nodes_[n].generation};
+                release(n);
+                ++fired;
+                fire(id, event);
+            }
+        }
+        return fired;
+    }
+
+    /** Heap bytes held for timer nodes. */
+    size_t bytes_reserved() const { return nodes_.capacity() * sizeof(Node) + free_.capacity() * sizeof(uint32_t); }
+
+private:
+    static constexpr int kLevels = 4;
+    static constexpr int kSlotBits = 8;
+    static constexpr uint32_t kSlots = 1u << kSlotBits;
+    static constexpr uint64_t kSlotMask = kSlots - 1;
+    static constexpr uint32_t kNone = UINT32_MAX;
+    static constexpr uint32_t kFree = UINT32_MAX;
+
+    struct Node {
+        uint64_t deadline = 0;
+        TimerEvent event;
+        uint32_t generation = 1;
+        // Index into heads_ of the list holding the node, or kFree.
+        uint32_t slot = kFree;
+        uint32_t prev = kNone;
+        uint32_t next = kNone;
+    };
+
+    /**
+     * Move now_ forward by at least one turn towards `turn`, jumping over
+     * turns on which nothing can fire, and redistribute the wheels at
+     * every block boundary crossed.
+     */
+    void step_to(uint64_t turn);
+    void cascade(int level);
+    void link(uint32_t n);
+    void unlink(uint32_t n);
+    void release(uint32_t n);
+
+    uint64_t now_;
+    size_t size_ = 0;
+    // Pending timers per wheel, to find stretches with nothing due.
+    size_t level_count_[kLevels] = {};
+    std::array<uint32_t, kLevels * kSlots> heads_;
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> free_;
+};
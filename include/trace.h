@@ -0,0 +1,59 @@
+/*
+ * Event tracing for the Survival Project.
+ *
+ * While tracing is enabled, every PROFILE_SCOPE additionally records a
+ * span (name, start, end) into a ring buffer owned by the calling
+ * thread. The buffers can be exported as Chrome trace JSON, which opens
+ * in chrome://tracing or the Perfetto UI and shows loader, job and
+ * command loop activity on a per-thread timeline.
+ *
+ * Ring buffers keep the most recent kRingCapacity spans per thread;
+ * older spans are overwritten. Export after stop() for a consistent
+ * snapshot.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <string>
+
+namespace trace {
+
+/** Number of spans retained per thread. */
+constexpr size_t kRingCapacity = 1 << 16;
+
+namespace detail {
+extern std::atomic<bool> enabled;
+}
+
+/** Whether spans are currently being recorded. */
+inline bool is_enabled() {
+    return detail::enabled.load(std::memory_order_relaxed);
+}
+
+/** Discard previously captured spans and start recording. */
+void start();
+
+/** Stop recording; captured spans are kept until the next start(). */
+void stop();
+
+/**
+ * Record a completed span on the calling thread. Called by
+ * profiler::Scope; `name` must outlive the trace.
+ */
+void record_span(const char *name,
+                 std::chrono::steady_clock::time_point begin,
+                 std::chrono::steady_clock::time_point end);
+
+/** Label the calling thread in exported traces. */
+void set_thread_name(const std::string &name);
+
+/** Write all captured spans as Chrome trace event JSON. */
+void write_chrome_json(std::ostream &out);
+
+/** Convenience wrapper writing the trace to a file. Returns false on I/O failure. */
+bool write_chrome_json_file(const std::string &path);
+
+} // namespace trace
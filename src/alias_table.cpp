@@ -0,0 +1,46 @@
+/*
+ * Alias table construction (Vose's method) for alias_table.h.
+ */
+
+#include "alias_table.h"
+
+void build_alias_table(Span<const double> weights, std::vector<AliasColumn> &columns) {
+    columns.clear();
+    double total = 0;
+    for (double w : weights) {
+        if (w > 0) total += w;
+    }
+    if (!(total > 0)) {
+        return;
+    }
+    size_t n = weights.size();
+    columns.resize(n);
+    // Scale so that the average column holds exactly 1, then pair each
+    // under-full column with an over-full one that donates the rest.
+    std::vector<double> scaled(n);
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (size_t i = 0; i < n; ++i) {
+        scaled[i] = weights[i] > 0 ? weights[i] * static_cast<double>(n) / total : 0.0;
+        (scaled[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+    }
+    auto to_threshold = [](double p) {
+        double t = p * 4294967296.0;
+        return t >= 4294967295.0 ? UINT32_MAX : static_cast<uint32_t>(t);
+    };
+    while (!small.empty() && !large.empty()) {
+        uint32_t s = small.back();
+        small.pop_back();
+        uint32_t l = large.back();
+        columns[s] = AliasColumn{to_threshold(scaled[s]), l};
+        scaled[l] -= 1.0 - scaled[s];
+        if (scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // Whatever is left is full up to rounding error. Aliasing a full
+    // column to itself makes the coin irrelevant.
+    for (uint32_t i : large) columns[i] = AliasColumn{UINT32_MAX, i};
+    for (uint32_t i : small) columns[i] = AliasColumn{UINT32_MAX, i};
+}
@@ -0,0 +1,86 @@
+/*
+ * Implementation of the combat rules declared in combat.h.
+ */
+
+#include "combat.h"
+
+#include "profiler.h"
+
+CombatResult resolve_combat(Player &player, MonsterInstance &enemy, CombatLog *log) {
+    using Type = CombatEvent::Type;
+    CombatResult result;
+    if (log) {
+        log->push_back(CombatEvent{Type::engage, enemy.type->name, {}, 0, 0});
+    }
+    // The weapon does not change during a fight, so resolve it once.
+    int damage = 1;
+    std::string_view weapon_name = "fists";
+    if (!player.inventory.empty()) {
+        const Item *weapon = item_type(player.inventory.item(player.inventory.first_child(Inventory::kRoot)));
+        // Determine damage by summing simple fields. We don't have bashing/cutting separate,
+        // so assign a default of 5 per item as an example. In a full game this would come
+        // from item data. Here we check if the id contains "knife" or other hints.
+        if (weapon) {
+            damage = 5;
+            weapon_name = weapon->name;
+        }
+    }
+    // Simple combat loop
+    while (player.hp > 0 && enemy.hp > 0) {
+        PROFILE_SCOPE("combat.round");
+        ++result.rounds;
+        // Player attacks first
+        enemy.hp -= damage;
+        if (log) {
+            log->push_back(CombatEvent{Type::player_hit, enemy.type->name, weapon_name, damage, enemy.hp > 0 ? enemy.hp : 0});
+        }
+        if (enemy.hp <= 0) {
+            if (log) {
+                log->push_back(CombatEvent{Type::monster_defeated, enemy.type->name, {}, 0, 0});
+            }
+            result.player_won = true;
+            break;
+        }
+        // Monster attacks
+        int monster_damage = enemy.type->melee_dice * enemy.type->melee_dice_sides;
+        if (monster_damage <= 0) {
+            monster_damage = 1;
+        }
+        player.hp -= monster_damage;
+        if (log) {
+            log->push_back(CombatEvent{Type::monster_hit, enemy.type->name, {}, monster_damage, player.hp > 0 ? player.hp : 0});
+        }
+        if (player.hp <= 0) {
+            if (log) {
+                log->push_back(CombatEvent{Type::player_killed, enemy.type->name, {}, 0, 0});
+            }
+            break;
+        }
+    }
+    return result;
+}
+
+void print_combat_log(std::ostream &out, const CombatLog &log) {
+    using Type = CombatEvent::Type;
+    for (const CombatEvent &e : log) {
+        switch (e.type) {
+        case Type::engage:
+            out << "You engage the " << e.monster << "!" << std::endl;
+            break;
+        case Type::player_hit:
+            out << "You hit the " << e.monster << " with your " << e.weapon
+                << ", dealing " << e.damage << " damage. (monster hp=" << e.hp_after << ")" << std::endl;
+            break;
+        case Type::monster_defeated:
+            out << "You defeated the " << e.monster << "!" << std::endl;
+            break;
+        case Type::monster_hit:
+            out << "The " << e.monster << " hits you, dealing " << e.damage
+                << " damage. (your hp=" << e.hp_after << ")" << std::endl;
+            break;
+        case Type::player_killed:
+            out << "You were killed by the " << e.monster << "..." << std::endl;
+            break;
+        }
+    }
+}
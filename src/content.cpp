@@ -0,0 +1,454 @@
+/*
+ * JSON loaders and lookups for the content declared in content.h.
+ */
+
+#include "content.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include "memory_tracker.h"
+#include "metrics.h"
+#include "profiler.h"
+
+RecipeTable load_recipes(const std::string &filename) {
+    PROFILE_SCOPE("load.recipes");
+    memory::TagScope tag(memory::Tag::content);
+    RecipeTable table;
+    std::ifstream f(filename);
+    if (!f) {
+        std::cerr << "Failed to open " << filename << std::endl;
+        return table;
+    }
+    // Recipes are collected here and copied into the table's arena in
+    // one block at the end; each recipe's components are copied into
+    // the arena as soon as the recipe is complete.
+    std::vector<Recipe> recipes;
+    std::vector<Component> components;
+    Recipe current;
+    std::string line;
+    while (std::getline(f, line)) {
+        // Trim leading spaces
+        auto pos = line.find_first_not_of(" \t");
+        if (pos == std::string::npos) continue;
+        std::string_view trimmed = std::string_view(line).substr(pos);
+        // New recipe when encountering '{'
+        if (trimmed.find("{") != std::string_view::npos) {
+            current = Recipe();
+            components.clear();
+        }
+        // Parse id
+        auto id_pos = trimmed.find("\"id\"");
+        if (id_pos != std::string_view::npos) {
+            auto colon = trimmed.find(':', id_pos);
+            auto q1 = trimmed.find('"', colon + 1);
+            auto q2 = trimmed.find('"', q1 + 1);
+            if (q1 != std::string_view::npos && q2 != std::string_view::npos) {
+                current.id = table.strings().intern(trimmed.substr(q1 + 1, q2 - q1 - 1));
+            }
+        }
+        // Parse result
+        auto res_pos = trimmed.find("\"result\"");
+        if (res_pos != std::string_view::npos) {
+            auto colon = trimmed.find(':', res_pos);
+            auto q1 = trimmed.find('"', colon + 1);
+            auto q2 = trimmed.find('"', q1 + 1);
+            if (q1 != std::string_view::npos && q2 != std::string_view::npos) {
+                current.result = table.strings().intern(trimmed.substr(q1 + 1, q2 - q1 - 1));
+            }
+        }
+        // Parse time, a duration string
+        auto time_pos = trimmed.find("\"time\"");
+        if (time_pos != std::string_view::npos) {
+            auto colon = trimmed.find(':', time_pos);
+            auto q1 = trimmed.find('"', colon + 1);
+            auto q2 = trimmed.find('"', q1 + 1);
+            if (q1 != std::string_view::npos && q2 != std::string_view::npos) {
+                std::string_view text = trimmed.substr(q1 + 1, q2 - q1 - 1);
+                int time = parse_duration(text);
+                if (time < 0) {
+                    std::cerr << "Recipe '" << current.id << "' has an out of range time '" << text << "'."
+                              << std::endl;
+                } else {
+                    current.time = time;
+                }
+            }
+        }
+        // Parse components entry lines like [ [ "id", qty ] ]
+        // We'll look for two quotes and a comma separating quantity
+        if (trimmed.find("[ [") != std::string_view::npos) {
+            auto q1 = trimmed.find('"');
+            auto q2 = trimmed.find('"', q1 + 1);
+            if (q1 != std::string_view::npos && q2 != std::string_view::npos) {
+                std::string_view comp_id = trimmed.substr(q1 + 1, q2 - q1 - 1);
+                // Find quantity after comma
+                auto comma = trimmed.find(',', q2);
+                if (comma != std::string_view::npos) {
+                    // `line` is NUL-terminated, so strtol can read in place.
+                    int qty = static_cast<int>(std::strtol(trimmed.data() + comma + 1, nullptr, 10));
+                    components.push_back(Component{table.strings().intern(comp_id), qty});
+                }
+            }
+        }
+        // When encountering '}', push current recipe if it has id and result
+        if (trimmed.find("}") != std::string_view::npos) {
+            if (!current.id.empty() && !current.result.empty()) {
+                current.components = table.arena().copy_array(components.data(), components.size());
+                recipes.push_back(current);
+                current = Recipe();
+                components.clear();
+            }
+        }
+    }
+    table.assign(recipes);
+    metrics::counter("recipes_loaded_total", "Recipes loaded from JSON.").add(table.size());
+    return table;
+}
+
+MonsterTable load_monsters(const std::string &filename) {
+    PROFILE_SCOPE("load.monsters");
+    memory::TagScope tag(memory::Tag::content);
+    MonsterTable table;
+    std::ifstream f(filename);
+    if (!f) {
+        std::cerr << "Failed to open " << filename << std::endl;
+        return table;
+    }
+    std::vector<Monster> monsters;
+    Monster current;
+    bool in_object = false;
+    std::string line;
+    // Helpers work on views into `line` so that scanning a monster costs
+    // no allocation beyond interning its strings.
+    auto trim = [](std::string_view s) {
+        size_t start = s.find_first_not_of(" \t\n\r");
+        size_t end = s.find_last_not_of(" \t\n\r");
+        if (start == std::string_view::npos || end == std::string_view::npos) return std::string_view();
+        return s.substr(start, end - start + 1);
+    };
+    auto extract_string_value = [&](std::string_view s) -> std::string_view {
+        auto colon = s.find(':');
+        if (colon == std::string_view::npos) return std::string_view();
+        std::string_view value = s.substr(colon + 1);
+        // find first and last quote
+        size_t q1 = value.find('"');
+        size_t q2 = value.find_last_of('"');
+        if (q1 != std::string_view::npos && q2 != std::string_view::npos && q2 > q1) {
+            return value.substr(q1 + 1, q2 - q1 - 1);
+        }
+        // fallback: trim, dropping a trailing comma
+        value = trim(value);
+        if (!value.empty() && value.back() == ',') value.remove_suffix(1);
+        return value;
+    };
+    auto extract_int_value = [&](std::string_view s) -> int {
+        auto colon = s.find(':');
+        if (colon == std::string_view::npos) return 0;
+        // The view points into a NUL-terminated line, so strtol can
+        // parse in place; it stops at the trailing comma.
+        return static_cast<int>(std::strtol(s.data() + colon + 1, nullptr, 10));
+    };
+    while (std::getline(f, line)) {
+        std::string_view t = trim(line);
+        if (t.empty() || t == "[" || t == "]") continue;
+        // Names may be written as { "str": "..." }, so handle them
+        // before the braces are mistaken for object boundaries.
+        if (in_object && t.find("\"name\"") != std::string_view::npos) {
+            auto str_pos = t.find("\"str\"");
+            current.name = table.strings().intern(
+                extract_string_value(str_pos != std::string_view::npos ? t.substr(str_pos) : t));
+            continue;
+        }
+        if (t.find('{') != std::string_view::npos) {
+            in_object = true;
+            current = Monster();
+            continue;
+        }
+        if (t.find('}') != std::string_view::npos) {
+            if (in_object) {
+                // push only if id and name have been set
+                if (!current.id.empty() && !current.name.empty()) {
+                    monsters.push_back(current);
+                }
+                in_object = false;
+            }
+            continue;
+        }
+        if (!in_object) continue;
+        if (t.find("\"id\"") != std::string_view::npos) {
+            current.id = table.strings().intern(extract_string_value(t));
+        } else if (t.find("\"hp\"") != std::string_view::npos) {
+            current.hp = extract_int_value(t);
+        } else if (t.find("\"melee_dice_sides\"") != std::string_view::npos) {
+            current.melee_dice_sides = extract_int_value(t);
+        } else if (t.find("\"melee_dice\"") != std::string_view::npos) {
+            current.melee_dice = extract_int_value(t);
+        } else if (t.find("\"armor\"") != std::string_view::npos) {
+            current.armor = extract_int_value(t);
+        } else if (t.find("\"speed\"") != std::string_view::npos) {
+            current.speed = extract_int_value(t);
+        }
+    }
+    table.assign(monsters);
+    metrics::counter("monsters_loaded_total", "Monsters loaded from JSON.").add(table.size());
+    return table;
+}
+
+namespace {
+
+/**
+ * Parse a quantity such as `500`, `"500 g"`, `"2 kg"`, `"250 ml"` or
+ * `"1 L"` following the colon in `s`. Bare numbers are taken to be in
+ * the base unit; `big_unit` (kg or L) multiplies by 1000. The view
+ * must point into a NUL-terminated line. Returns -1 if the quantity is
+ * negative, not finite or does not fit in an int.
+ */
+int parse_quantity(std::string_view s, std::string_view big_unit) {
+    auto colon = s.find(':');
+    if (colon == std::string_view::npos) return 0;
+    const char *p = s.data() + colon + 1;
+    while (*p == ' ' || *p == '"') ++p;
+    char *unit = nullptr;
+    double value = std::strtod(p, &unit);
+    while (*unit == ' ') ++unit;
+    std::string_view rest(unit);
+    if (rest.substr(0, big_unit.size()) == big_unit) {
+        value *= 1000;
+    }
+    if (!std::isfinite(value) || value < 0 || value + 0.5 >= static_cast<double>(INT_MAX)) return -1;
+    return static_cast<int>(value + 0.5);
+}
+
+} // namespace
+
+size_t next_quoted(std::string_view s, size_t from, std::string_view &out) {
+    size_t q1 = s.find('"', from);
+    size_t q2 = q1 == std::string_view::npos ? q1 : s.find('"', q1 + 1);
+    if (q2 == std::string_view::npos) return std::string_view::npos;
+    out = s.substr(q1 + 1, q2 - q1 - 1);
+    return q2 + 1;
+}
+
+double number_after(std::string_view s, std::string_view key, double fallback) {
+    size_t k = s.find(key);
+    if (k == std::string_view::npos) return fallback;
+    size_t colon = s.find(':', k + key.size());
+    return colon == std::string_view::npos ? fallback : std::strtod(s.data() + colon + 1, nullptr);
+}
+
+ItemTable load_items(const std::string &filename) {
+    PROFILE_SCOPE("load.items");
+    memory::TagScope tag(memory::Tag::content);
+    ItemTable table;
+    std::ifstream f(filename);
+    if (!f) {
+        std::cerr << "Failed to open " << filename << std::endl;
+        return table;
+    }
+    std::vector<Item> items;
+    std::vector<Pocket> pockets;
+    using IdCache = std::vector<std::pair<std::string_view, uint32_t>>;
+    IdCache material_cache;
+    IdCache flag_cache;
+    Item current;
+    bool in_object = false;
+    std::string line;
+    auto quoted_value = [](std::string_view s, size_t key_pos) {
+        auto colon = s.find(':', key_pos);
+        auto q1 = s.find('"', colon + 1);
+        auto q2 = s.find('"', q1 + 1);
+        if (colon == std::string_view::npos || q1 == std::string_view::npos || q2 == std::string_view::npos) {
+            return std::string_view();
+        }
+        return s.substr(q1 + 1, q2 - q1 - 1);
+    };
+    // String arrays such as "material": ["steel", "wood"] are resolved
+    // to dense ids. The few distinct names are cached locally so the
+    // shared vocabulary (and its lock) is only consulted once each.
+    auto id_set = [&](std::string_view s, Vocabulary &names, IdCache &cache, auto &set) {
+        size_t pos = s.find('[');
+        while (pos != std::string_view::npos) {
+            size_t q1 = s.find('"', pos + 1);
+            size_t q2 = q1 == std::string_view::npos ? q1 : s.find('"', q1 + 1);
+            if (q2 == std::string_view::npos) break;
+            std::string_view name = s.substr(q1 + 1, q2 - q1 - 1);
+            auto hit = std::find_if(cache.begin(), cache.end(), [&](const auto &e) { return e.first == name; });
+            uint32_t id;
+            if (hit != cache.end()) {
+                id = hit->second;
+            } else {
+                id = names.intern(name);
+                cache.emplace_back(table.strings().intern(name), id);
+            }
+            if (id != Vocabulary::kInvalid) set.set(id);
+            pos = q2;
+        }
+    };
+    while (std::getline(f, line)) {
+        std::string_view t(line);
+        size_t start = t.find_first_not_of(" \t");
+        if (start == std::string_view::npos) continue;
+        t.remove_prefix(start);
+        // The first quoted string on a line is its key; dispatching on
+        // it scans each line once.
+        std::string_view key;
+        size_t k1 = t.find('"');
+        size_t k2 = k1 == std::string_view::npos ? k1 : t.find('"', k1 + 1);
+        if (k2 != std::string_view::npos) {
+            key = t.substr(k1 + 1, k2 - k1 - 1);
+        }
+        if (key == "name") {
+            // Names are written as { "str": "..." } or as a plain string.
+            auto str_pos = t.find("\"str\"");
+            current.name = table.strings().intern(quoted_value(t, str_pos != std::string_view::npos ? str_pos : k1));
+        } else if (key == "max_contains_volume" || key == "max_contains_weight") {
+            // Pockets are written one per line as
+            // { "max_contains_volume": ..., "max_contains_weight": ... }.
+            Pocket pocket;
+            auto pocket_volume = t.find("\"max_contains_volume\"");
+            auto pocket_weight = t.find("\"max_contains_weight\"");
+            if (pocket_volume != std::string_view::npos) {
+                pocket.max_volume = parse_quantity(t.substr(pocket_volume), "L");
+            }
+            if (pocket_weight != std::string_view::npos) {
+                pocket.max_weight = parse_quantity(t.substr(pocket_weight), "kg");
+            }
+            if (pocket.max_volume < 0 || pocket.max_weight < 0) {
+                std::cerr << "Item '" << current.id << "' has an out of range pocket in '" << t << "'." << std::endl;
+            } else {
+                pockets.push_back(pocket);
+            }
+        } else if (t[0] == '{') {
+            in_object = true;
+            current = Item();
+            pockets.clear();
+        } else if (t[0] == '}') {
+            if (in_object && !current.id.empty() && !current.name.empty()) {
+                current.pockets = table.arena().copy_array(pockets.data(), pockets.size());
+                items.push_back(current);
+            }
+            in_object = false;
+        } else if (key == "id") {
+            current.id = table.strings().intern(quoted_value(t, k1));
+        } else if (key == "category") {
+            current.category = table.strings().intern(quoted_value(t, k1));
+        } else if (key == "material") {
+            id_set(t.substr(k2), material_names(), material_cache, current.materials);
+        } else if (key == "flags") {
+            id_set(t.substr(k2), flag_names(), flag_cache, current.flags);
+        } else if (key == "weight" || key == "volume") {
+            int quantity = parse_quantity(t, key == "weight" ? "kg" : "L");
+            if (quantity < 0) {
+                std::cerr << "Item '" << current.id << "' has an out of range " << key << " in '" << t << "'."
+                          << std::endl;
+            } else {
+                (key == "weight" ? current.weight : current.volume) = quantity;
+            }
+        } else if (key == "spoils_in") {
+            // A duration string, or a bare number of turns.
+            std::string_view value = quoted_value(t, k1);
+            if (value.empty()) value = t.substr(t.find(':') + 1);
+            int spoils_in = parse_duration(value);
+            if (spoils_in < 0) {
+                std::cerr << "Item '" << current.id << "' has an out of range spoils_in '" << value << "'."
+                          << std::endl;
+            } else {
+                current.spoils_in = spoils_in;
+            }
+        }
+    }
+    table.assign(items);
+    metrics::counter("items_loaded_total", "Items loaded from JSON.").add(table.size());
+    return table;
+}
+
+int parse_duration(std::string_view text) {
+    // Accumulate in 64 bits and give up as soon as the total leaves the
+    // range of int, before the products themselves could overflow.
+    int64_t turns = 0;
+    size_t i = 0;
+    while (i < text.size()) {
+        while (i < text.size() && text[i] == ' ') ++i;
+        size_t digits = i;
+        int64_t value = 0;
+        while (i < text.size() && text[i] >= '0' && text[i] <= '9') {
+            value = value * 10 + (text[i++] - '0');
+            if (value > INT_MAX) return -1;
+        }
+        if (i == digits) break;
+        while (i < text.size() && text[i] == ' ') ++i;
+        size_t unit = i;
+        while (i < text.size() && text[i] != ' ' && (text[i] < '0' || text[i] > '9')) ++i;
+        switch (unit < text.size() ? text[unit] : 's') {
+        case 'd': turns += value * 86400; break;
+        case 'h': turns += value * 3600; break;
+        case 'm': turns += value * 60; break;
+        default: turns += value; break;
+        }
+        if (turns > INT_MAX) return -1;
+    }
+    return static_cast<int>(turns);
+}
+
+Vocabulary &material_names() {
+    static Vocabulary names("materials", MaterialSet::kBits);
+    return names;
+}
+
+Vocabulary &flag_names() {
+    static Vocabulary names("flags", FlagSet::kBits);
+    return names;
+}
+
+namespace {
+
+metrics::Counter &lookups_total() {
+    static metrics::Counter &counter =
+        metrics::counter("content_lookups_total", "Item, recipe and monster lookups by id.");
+    return counter;
+}
+
+} // namespace
+
+const Item *find_item(const ItemTable &items, const Id &id) {
+    lookups_total().add();
+    return items.find(id);
+}
+
+const Recipe *find_recipe(const RecipeTable &recipes, const Id &id) {
+    lookups_total().add();
+    return recipes.find(id);
+}
+
+const Monster *find_monster(const MonsterTable &monsters, const Id &id) {
+    lookups_total().add();
+    return monsters.find(id);
+}
+
+const Item *find_item(Span<const Item> items, const Id &id) {
+    lookups_total().add();
+    auto it = std::find_if(items.begin(), items.end(), [&](const Item &itm) {
+        return itm.id == id;
+    });
+    return it != items.end() ? &*it : nullptr;
+}
+
+const Recipe *find_recipe(Span<const Recipe> recipes, const Id &id) {
+    lookups_total().add();
+    auto it = std::find_if(recipes.begin(), recipes.end(), [&](const Recipe &rec) {
+        return rec.id == id;
+    });
+    return it != recipes.end() ? &*it : nullptr;
+}
+
+const Monster *find_monster(Span<const Monster> monsters, const Id &id) {
+    lookups_total().add();
+    auto it = std::find_if(monsters.begin(), monsters.end(), [&](const Monster &m) {
+        return m.id == id;
+    });
+    return it != monsters.end() ? &*it : nullptr;
+}
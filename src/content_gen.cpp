@@ -0,0 +1,418 @@
+/*
+ * Implementation of the synthetic content generator declared in
+ * content_gen.h.
+ */
+
+#include "content_gen.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "profiler.h"
+
+namespace {
+
+using Rng = std::mt19937_64;
+
+const char *const kAdjectives[] = {
+    "rusty", "heavy", "small", "makeshift", "sturdy", "old", "military", "crude",
+    "folding", "reinforced", "plastic", "wooden", "steel", "cheap", "fine", "large",
+};
+const char *const kNouns[] = {
+    "knife", "pipe", "bottle", "jacket", "rope", "hammer", "can", "pot",
+    "backpack", "lighter", "bandage", "plank", "nail", "wrench", "boots", "helmet",
+    "radio", "battery", "flashlight", "axe", "tarp", "blanket", "shovel", "canteen",
+};
+const char *const kMonsterKinds[] = {
+    "zombie", "feral", "hound", "spider", "bear", "wasp", "boar", "mutant",
+    "crawler", "brute", "shrieker", "stalker",
+};
+
+// Materials ordered by frequency; picked with a Zipf-like weighting so a
+// handful dominate, as in real item data.
+const char *const kMaterials[] = {
+    "steel", "plastic", "cotton", "wood", "leather", "iron", "glass", "paper",
+    "aluminum", "rubber", "kevlar", "bone", "ceramic", "copper", "wool", "nylon",
+};
+
+// Item types with the share of items each represents.
+struct ItemKind {
+    const char *type;
+    const char *category;
+    double weight;
+};
+const ItemKind kItemKinds[] = {
+    {"GENERIC", "spare_parts", 0.35}, {"TOOL", "tools", 0.2},
+    {"ARMOR", "clothing", 0.2}, {"COMESTIBLE", "food", 0.15},
+    {"GUN", "guns", 0.05}, {"BOOK", "books", 0.05},
+    {"GENERIC", "container", 0.02},
+};
+
+const char *const kFlags[] = {
+    "WATERPROOF", "FLAMMABLE", "CONDUCTIVE", "SHARP", "BELTED", "VARSIZE", "FRAGILE", "STURDY",
+};
+
+const char *const kSkills[] = {
+    "fabrication", "survival", "cooking", "tailor", "mechanics", "electronics", "firstaid",
+};
+
+template <typename T, size_t N>
+constexpr size_t count_of(const T (&)[N]) {
+    return N;
+}
+
+/** Discrete distribution with weight 1/(rank+1) over n choices. */
+std::discrete_distribution<size_t> zipf(size_t n) {
+    std::vector<double> weights(n);
+    for (size_t i = 0; i < n; ++i) {
+        weights[i] = 1.0 / static_cast<double>(i + 1);
+    }
+    return std::discrete_distribution<size_t>(weights.begin(), weights.end());
+}
+
+/** Id shared by the item/monster/recipe written for index `i`. */
+std::string item_id(const std::string &prefix, size_t i) {
+    return prefix + "item_" + std::to_string(i);
+}
+
+std::string format_volume(double ml) {
+    long rounded = std::max(1L, std::lround(ml));
+    // Bulky items are usually written in whole liters.
+    if (rounded >= 1000) {
+        return std::to_string((rounded + 500) / 1000) + " L";
+    }
+    return std::to_string(rounded) + " ml";
+}
+
+std::string format_duration(long seconds) {
+    if (seconds >= 3600 && seconds % 3600 == 0) {
+        return std::to_string(seconds / 3600) + " h";
+    }
+    if (seconds >= 60) {
+        return std::to_string(seconds / 60) + " m";
+    }
+    return std::to_string(seconds) + " s";
+}
+
+bool open_output(const std::filesystem::path &path, std::ofstream &out) {
+    out.open(path);
+    if (!out) {
+        std::cerr << "Failed to open " << path.string() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Write `count` items with ids prefix + "item_" + (first + i).
+ */
+void write_items(std::ostream &out, const std::string &prefix, size_t first, size_t count, Rng &rng) {
+    std::vector<double> kind_weights;
+    for (const ItemKind &k : kItemKinds) {
+        kind_weights.push_back(k.weight);
+    }
+    std::discrete_distribution<size_t> kind(kind_weights.begin(), kind_weights.end());
+    std::discrete_distribution<size_t> material = zipf(count_of(kMaterials));
+    std::uniform_int_distribution<size_t> adjective(0, count_of(kAdjectives) - 1);
+    std::uniform_int_distribution<size_t> noun(0, count_of(kNouns) - 1);
+    std::uniform_int_distribution<size_t> flag(0, count_of(kFlags) - 1);
+    // Median ~300 g and ~250 ml with a long tail of bulky items.
+    std::lognormal_distribution<double> weight(std::log(300.0), 1.2);
+    std::lognormal_distribution<double> volume(std::log(250.0), 1.1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::uniform_int_distribution<int> spoil_days(1, 30);
+
+    out << "[\n";
+    for (size_t i = 0; i < count; ++i) {
+        const ItemKind &k = kItemKinds[kind(rng)];
+        std::string name = std::string(kAdjectives[adjective(rng)]) + " " + kNouns[noun(rng)];
+        double item_weight = std::max(1.0, std::round(weight(rng)));
+        double item_volume = volume(rng);
+        out << "  {\n"
+            << "    \"type\": \"" << k.type << "\",\n"
+            << "    \"id\": \"" << item_id(prefix, first + i) << "\",\n"
+            << "    \"name\": { \"str\": \"" << name << "\" },\n"
+            << "    \"category\": \"" << k.category << "\",\n"
+            << "    \"weight\": " << static_cast<long>(item_weight) << ",\n"
+            << "    \"volume\": \"" << format_volume(item_volume) << "\",\n"
+            << "    \"description\": \"A generated " << name << ".\",\n";
+        if (std::string(k.type) == "COMESTIBLE") {
+            out << "    \"spoils_in\": \"" << spoil_days(rng) << " d\",\n";
+        }
+        if (unit(rng) < 0.3) {
+            out << "    \"flags\": [\"" << kFlags[flag(rng)] << "\"],\n";
+        }
+        size_t first_material = material(rng);
+        out << "    \"material\": [\"" << kMaterials[first_material] << "\"";
+        if (unit(rng) < 0.25) {
+            size_t second = material(rng);
+            if (second != first_material) {
+                out << ", \"" << kMaterials[second] << "\"";
+            }
+        }
+        out << "]";
+        if (std::string(k.category) == "container") {
+            // One pocket holding a few times the container's own bulk.
+            out << ",\n    \"pocket_data\": [\n"
+                << "      { \"max_contains_volume\": \"" << format_volume(item_volume * 4) << "\", "
+                << "\"max_contains_weight\": " << static_cast<long>(item_weight * 10) << " }\n"
+                << "    ]";
+        }
+        out << "\n"
+            << "  }" << (i + 1 < count ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+void write_monsters(std::ostream &out, size_t count, Rng &rng) {
+    std::uniform_int_distribution<size_t> adjective(0, count_of(kAdjectives) - 1);
+    std::discrete_distribution<size_t> kind = zipf(count_of(kMonsterKinds));
+    std::lognormal_distribution<double> hp(std::log(40.0), 0.8);
+    std::normal_distribution<double> speed(100.0, 20.0);
+    std::discrete_distribution<int> dice({0, 50, 35, 15});
+    std::uniform_int_distribution<int> sides(2, 8);
+    std::discrete_distribution<int> armor({50, 20, 12, 8, 6, 4});
+
+    out << "[\n";
+    for (size_t i = 0; i < count; ++i) {
+        int monster_hp = std::max(1, static_cast<int>(std::lround(hp(rng))));
+        int melee_dice = dice(rng);
+        int melee_sides = sides(rng);
+        out << "  {\n"
+            << "    \"type\": \"MONSTER\",\n"
+            << "    \"id\": \"mon_" << i << "\",\n"
+            << "    \"name\": { \"str\": \"" << kAdjectives[adjective(rng)] << " "
+            << kMonsterKinds[kind(rng)] << "\" },\n"
+            << "    \"hp\": " << monster_hp << ",\n"
+            << "    \"speed\": " << std::clamp(static_cast<int>(std::lround(speed(rng))), 30, 250) << ",\n"
+            << "    \"difficulty\": " << (monster_hp / 10 + melee_dice * melee_sides / 4) << ",\n"
+            << "    \"melee_dice\": " << melee_dice << ",\n"
+            << "    \"melee_dice_sides\": " << melee_sides << ",\n"
+            << "    \"armor\": " << armor(rng) << ",\n"
+            << "    \"description\": \"A generated monster.\"\n"
+            << "  }" << (i + 1 < count ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+/**
+ * Write `count` recipes with ids prefix + "recipe_" + i. Results and
+ * components reference items in [0, base_items) of the base set and,
+ * for mods, [0, own_items) of the mod's own items.
+ */
+void write_recipes(std::ostream &out, const std::string &prefix, size_t count,
+                   size_t base_items, size_t own_items, Rng &rng) {
+    std::discrete_distribution<int> components({0, 40, 35, 15, 10});
+    std::discrete_distribution<int> quantity({0, 60, 20, 10, 5, 5});
+    std::uniform_int_distribution<size_t> skill(0, count_of(kSkills) - 1);
+    std::discrete_distribution<int> difficulty({20, 20, 15, 12, 10, 8, 6, 4, 2, 2, 1});
+    std::lognormal_distribution<double> minutes(std::log(20.0), 1.0);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    // Popular components (rope, nails...) are reused by many recipes.
+    std::discrete_distribution<size_t> base_pick = zipf(std::min<size_t>(base_items, 4096));
+    std::uniform_int_distribution<size_t> base_any(0, base_items - 1);
+    std::uniform_int_distribution<size_t> own_any(0, own_items > 0 ? own_items - 1 : 0);
+
+    auto pick_component = [&]() {
+        if (own_items > 0 && unit(rng) < 0.5) {
+            return item_id(prefix, own_any(rng));
+        }
+        return item_id("", unit(rng) < 0.7 ? base_pick(rng) : base_any(rng));
+    };
+
+    out << "[\n";
+    for (size_t i = 0; i < count; ++i) {
+        std::string result = own_items > 0 ? item_id(prefix, own_any(rng)) : item_id("", base_any(rng));
+        long seconds = std::max(60L, std::lround(minutes(rng)) * 60);
+        out << "  {\n"
+            << "    \"type\": \"recipe\",\n"
+            << "    \"id\": \"" << prefix << "recipe_" << i << "\",\n"
+            << "    \"result\": \"" << result << "\",\n"
+            << "    \"skill_used\": \"" << kSkills[skill(rng)] << "\",\n"
+            << "    \"difficulty\": " << difficulty(rng) << ",\n"
+            << "    \"time\": \"" << format_duration(seconds) << "\",\n"
+            << "    \"components\": [\n";
+        int n = components(rng);
+        for (int c = 0; c < n; ++c) {
+            out << "      [ [ \"" << pick_component() << "\", " << quantity(rng) << " ]";
+            // Occasionally offer an alternative, as CDDA recipes do.
+            if (unit(rng) < 0.2) {
+                out << ", [ \"" << pick_component() << "\", " << quantity(rng) << " ]";
+            }
+            out << " ]" << (c + 1 < n ? "," : "") << "\n";
+        }
+        out << "    ]\n"
+            << "  }" << (i + 1 < count ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+/**
+ * Write `count` item groups with ids "group_" + i over items in
+ * [0, items). Some entries nest an earlier group, so nesting is acyclic
+ * and a few levels deep.
+ */
+void write_item_groups(std::ostream &out, size_t count, size_t items, Rng &rng) {
+    std::uniform_int_distribution<int> entries(2, 30);
+    std::discrete_distribution<size_t> item_pick = zipf(std::min<size_t>(items, 4096));
+    std::uniform_int_distribution<size_t> item_any(0, items - 1);
+    // Weights span two orders of magnitude, like rare and common loot.
+    std::uniform_real_distribution<double> log_weight(0.0, std::log(100.0));
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    out << "[\n";
+    for (size_t i = 0; i < count; ++i) {
+        out << "  {\n"
+            << "    \"type\": \"item_group\",\n"
+            << "    \"id\": \"group_" << i << "\",\n"
+            << "    \"subtype\": \"distribution\",\n"
+            << "    \"items\": [\n";
+        int n = entries(rng);
+        for (int e = 0; e < n; ++e) {
+            long weight = std::lround(std::exp(log_weight(rng)));
+            if (i > 0 && unit(rng) < 0.1) {
+                std::uniform_int_distribution<size_t> earlier(0, i - 1);
+                out << "      { \"group\": \"group_" << earlier(rng) << "\", \"prob\": " << weight << " }";
+            } else {
+                size_t item = unit(rng) < 0.5 ? item_pick(rng) : item_any(rng);
+                out << "      [ \"" << item_id("", item) << "\", " << weight << " ]";
+            }
+            out << (e + 1 < n ? "," : "") << "\n";
+        }
+        out << "    ]\n"
+            << "  }" << (i + 1 < count ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+/**
+ * Write `count` monster groups with ids "mongroup_" + i over monsters in
+ * [0, monsters). Common monsters appear in many groups and most roam
+ * alone or in small packs.
+ */
+void write_monster_groups(std::ostream &out, size_t count, size_t monsters, Rng &rng) {
+    std::uniform_int_distribution<int> entries(1, 8);
+    std::discrete_distribution<size_t> monster_pick = zipf(std::min<size_t>(monsters, 1024));
+    std::uniform_int_distribution<int> weight(1, 100);
+    std::discrete_distribution<int> pack_max({0, 50, 15, 15, 10, 5, 5});
+
+    out << "[\n";
+    for (size_t i = 0; i < count; ++i) {
+        out << "  {\n"
+            << "    \"type\": \"monstergroup\",\n"
+            << "    \"id\": \"mongroup_" << i << "\",\n"
+            << "    \"monsters\": [\n";
+        int n = entries(rng);
+        for (int e = 0; e < n; ++e) {
+            out << "      { \"monster\": \"mon_" << monster_pick(rng) << "\", \"weight\": " << weight(rng);
+            int max = pack_max(rng);
+            if (max > 1) {
+                out << ", \"pack_size\": [ 1, " << max << " ]";
+            }
+            out << " }" << (e + 1 < n ? "," : "") << "\n";
+        }
+        out << "    ]\n"
+            << "  }" << (i + 1 < count ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+} // namespace
+
+bool generate_content(const ContentGenOptions &options, ContentGenResult &result) {
+    PROFILE_SCOPE("gen.content");
+    namespace fs = std::filesystem;
+    if (options.items == 0) {
+        std::cerr << "Content generation needs at least one item." << std::endl;
+        return false;
+    }
+    fs::path json_dir = fs::path(options.out_dir) / "data" / "json";
+    fs::path mods_dir = fs::path(options.out_dir) / "data" / "mods";
+    std::error_code ec;
+    fs::create_directories(json_dir, ec);
+    if (ec) {
+        std::cerr << "Failed to create " << json_dir.string() << ": " << ec.message() << std::endl;
+        return false;
+    }
+    result.items_path = (json_dir / "items.json").string();
+    result.monsters_path = (json_dir / "monsters.json").string();
+    result.recipes_path = (json_dir / "recipes.json").string();
+    result.item_groups_path = (json_dir / "item_groups.json").string();
+    result.monster_groups_path = (json_dir / "monster_groups.json").string();
+    result.mods_dir = mods_dir.string();
+
+    // Each file gets its own generator so sizes of one type do not
+    // change the content of another.
+    std::ofstream out;
+    {
+        Rng rng(options.seed * 3 + 0);
+        if (!open_output(result.items_path, out)) return false;
+        write_items(out, "", 0, options.items, rng);
+        out.close();
+    }
+    {
+        Rng rng(options.seed * 3 + 1);
+        if (!open_output(result.monsters_path, out)) return false;
+        write_monsters(out, options.monsters, rng);
+        out.close();
+    }
+    {
+        Rng rng(options.seed * 3 + 2);
+        if (!open_output(result.recipes_path, out)) return false;
+        write_recipes(out, "", options.recipes, options.items, 0, rng);
+        out.close();
+    }
+    {
+        Rng rng(options.seed * 11 + 5);
+        if (!open_output(result.item_groups_path, out)) return false;
+        write_item_groups(out, options.item_groups, options.items, rng);
+        out.close();
+    }
+    {
+        Rng rng(options.seed * 11 + 6);
+        if (!open_output(result.monster_groups_path, out)) return false;
+        write_monster_groups(out, options.monsters > 0 ? options.monster_groups : 0, options.monsters, rng);
+        out.close();
+    }
+
+    for (size_t m = 0; m < options.mods; ++m) {
+        std::string mod_id = "gen_mod_" + std::to_string(m);
+        fs::path dir = mods_dir / mod_id;
+        fs::create_directories(dir, ec);
+        if (ec) {
+            std::cerr << "Failed to create " << dir.string() << ": " << ec.message() << std::endl;
+            return false;
+        }
+        Rng rng(options.seed * 7919 + m);
+        if (!open_output(dir / "modinfo.json", out)) return false;
+        // Every mod after the first depends on its predecessor, giving
+        // the loader a dependency chain to resolve.
+        out << "[\n  {\n"
+            << "    \"type\": \"MOD_INFO\",\n"
+            << "    \"id\": \"" << mod_id << "\",\n"
+            << "    \"name\": \"Generated Mod " << m << "\",\n"
+            << "    \"description\": \"Synthetic content for scale testing.\",\n"
+            << "    \"category\": \"content\",\n"
+            << "    \"dependencies\": [";
+        if (m > 0) {
+            out << "\"gen_mod_" << (m - 1) << "\"";
+        }
+        out << "]\n  }\n]\n";
+        out.close();
+
+        std::string prefix = mod_id + "_";
+        if (!open_output(dir / "items_mod.json", out)) return false;
+        write_items(out, prefix, 0, options.mod_items, rng);
+        out.close();
+        if (!open_output(dir / "recipes_mod.json", out)) return false;
+        write_recipes(out, prefix, options.mod_items / 2, options.items, options.mod_items, rng);
+        out.close();
+    }
+    return true;
+}
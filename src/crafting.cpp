@@ -0,0 +1,73 @@
+/*
+ * Implementation of the crafting rules declared in crafting.h.
+ */
+
+#include "crafting.h"
+
+#include <memory_resource>
+#include <vector>
+
+#include "frame_allocator.h"
+#include "profiler.h"
+#include "simulation.h"
+
+bool has_components(const Player &player, const Recipe &recipe) {
+    PROFILE_SCOPE("craft.check");
+    for (const auto &req : recipe.components) {
+        int qty_found = 0;
+        player.inventory.for_each_item([&](Inventory::NodeId n, ItemHandle) {
+            qty_found += player.inventory.type(n)->id == req.id;
+        });
+        if (qty_found < req.count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool consume_components(Player &player, const Recipe &recipe) {
+    PROFILE_SCOPE("craft.components");
+    // Candidates only live until the craft succeeds or is rolled back.
+    std::pmr::vector<ItemHandle> removed_items(frame::resource());
+    for (const auto &req : recipe.components) {
+        const Id &comp_id = req.id;
+        int qty_needed = req.count;
+        int qty_found = 0;
+        // Remove items up to qty_needed
+        for (int i = 0; i < qty_needed; ++i) {
+            ItemHandle removed;
+            if (player.remove_item(comp_id, removed)) {
+                removed_items.push_back(removed);
+                qty_found++;
+            } else {
+                break;
+            }
+        }
+        if (qty_found < qty_needed) {
+            // Return removed items back to inventory
+            for (const auto &itm : removed_items) {
+                player.add_item(itm);
+            }
+            return false;
+        }
+    }
+    // The components are used up.
+    for (ItemHandle h : removed_items) {
+        item_pool().destroy(h);
+    }
+    return true;
+}
+
+ItemHandle make_result(const Recipe &recipe, Span<const Item> items, uint64_t turn) {
+    if (const Item *known = find_item(items, recipe.result)) {
+        return spawn_item(*known, turn);
+    }
+    return ItemHandle();
+}
+
+uint64_t craft_safe_turns(const Map &map, const Hordes &hordes, Point tile, int radius, uint64_t now) {
+    uint64_t quiet = hordes.quiet_turns(submap_of(tile), radius, now);
+    int d = nearest_monster(map, tile, radius);
+    if (d < 0) return quiet;
+    return d > kInterruptDistance ? std::min(quiet, static_cast<uint64_t>(d - kInterruptDistance)) : 0;
+}
@@ -0,0 +1,69 @@
+/*
+ * Field types and per-submap field storage declared in field.h.
+ */
+
+#include "field.h"
+
+#include <algorithm>
+
+#include "memory_tracker.h"
+
+namespace {
+
+// Fire at full intensity burns about 20 turns a level and lights each
+// neighbour within a few turns; smoke clears in a minute or so, gas
+// lingers for several.
+constexpr FieldInfo kFieldInfo[kFieldTypes] = {
+    {"fire", '*', 0.05, 0.15},
+    {"smoke", '%', 0.1, 0.3},
+    {"toxic_gas", '&', 0.01, 0.3},
+};
+
+} // namespace
+
+const FieldInfo &field_info(FieldType type) {
+    return kFieldInfo[static_cast<int>(type)];
+}
+
+bool parse_field_type(std::string_view name, FieldType &type) {
+    for (int t = 0; t < kFieldTypes; ++t) {
+        if (name == kFieldInfo[t].name) {
+            type = static_cast<FieldType>(t);
+            return true;
+        }
+    }
+    return false;
+}
+
+void FieldLayer::add(int tile, FieldType type, int amount) {
+    uint8_t &value = intensity_[tile][static_cast<int>(type)];
+    value = static_cast<uint8_t>(std::min(value + amount, kMaxIntensity));
+    if (value > 0 && !in_active_[tile]) {
+        memory::TagScope tag(memory::Tag::world);
+        in_active_[tile] = true;
+        active_.push_back(static_cast<uint16_t>(tile));
+    }
+}
+
+void FieldLayer::remove(int tile, FieldType type, int amount) {
+    uint8_t &value = intensity_[tile][static_cast<int>(type)];
+    value = static_cast<uint8_t>(std::max(value - amount, 0));
+}
+
+bool FieldLayer::ignite(int tile, int intensity) {
+    if (burnt_[tile]) return false;
+    burnt_[tile] = true;
+    add(tile, FieldType::fire, intensity);
+    return true;
+}
+
+void FieldLayer::compact() {
+    auto live = [this](uint16_t tile) {
+        const auto &fields = intensity_[tile];
+        bool any = std::any_of(fields.begin(), fields.end(), [](uint8_t v) { return v > 0; });
+        if (!any) in_active_[tile] = false;
+        return any;
+    };
+    active_.erase(std::remove_if(active_.begin(), active_.end(), [&](uint16_t tile) { return !live(tile); }),
+                  active_.end());
+}
@@ -0,0 +1,136 @@
+/*
+ * Implementation of the frame allocator declared in frame_allocator.h.
+ */
+
+#include "frame_allocator.h"
+
+#include <atomic>
+
+#include "memory_tracker.h"
+#include "metrics.h"
+
+namespace frame {
+
+namespace {
+
+std::atomic<uint64_t> g_turn{0};
+std::atomic<uint64_t> g_frame_allocations{0};
+std::atomic<uint64_t> g_frame_bytes{0};
+
+struct TurnState {
+    uint64_t frame_allocations_at_start = 0;
+    uint64_t frame_bytes_at_start = 0;
+    uint64_t heap_allocations_at_start = 0;
+    TurnStats last;
+};
+
+TurnState &turn_state() {
+    static TurnState state;
+    return state;
+}
+
+uint64_t heap_allocations() {
+    uint64_t total = 0;
+    for (size_t i = 0; i < static_cast<size_t>(memory::Tag::count); ++i) {
+        total += memory::stats(static_cast<memory::Tag>(i)).allocations;
+    }
+    return total;
+}
+
+} // namespace
+
+FrameArena::FrameArena(size_t initial_size) : initial_size_(initial_size) {}
+
+void FrameArena::add_block(size_t min_size) {
+    memory::TagScope tag(memory::Tag::frame);
+    size_t size = initial_size_;
+    if (!block_sizes_.empty()) {
+        size = block_sizes_.back() * 2;
+    }
+    while (size < min_size) {
+        size *= 2;
+    }
+    blocks_.emplace_back(new char[size]);
+    block_sizes_.push_back(size);
+    cursor_ = reinterpret_cast<uintptr_t>(blocks_.back().get());
+    limit_ = cursor_ + size;
+    reserved_ += size;
+}
+
+void *FrameArena::do_allocate(size_t bytes, size_t alignment) {
+    uintptr_t p = (cursor_ + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+    if (p + bytes > limit_) {
+        add_block(bytes + alignment);
+        p = (cursor_ + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+    }
+    cursor_ = p + bytes;
+    used_ += bytes;
+    g_frame_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_frame_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    return reinterpret_cast<void *>(p);
+}
+
+void FrameArena::reset() {
+    if (blocks_.size() > 1) {
+        // Coalesce so the next turn of similar size fits in one block.
+        size_t total = reserved_;
+        blocks_.clear();
+        block_sizes_.clear();
+        reserved_ = 0;
+        memory::TagScope tag(memory::Tag::frame);
+        blocks_.emplace_back(new char[total]);
+        block_sizes_.push_back(total);
+        reserved_ = total;
+    }
+    if (!blocks_.empty()) {
+        cursor_ = reinterpret_cast<uintptr_t>(blocks_.front().get());
+        limit_ = cursor_ + block_sizes_.front();
+    }
+    used_ = 0;
+}
+
+void begin_turn() {
+    TurnState &state = turn_state();
+    uint64_t frame_allocs = g_frame_allocations.load(std::memory_order_relaxed);
+    uint64_t frame_bytes = g_frame_bytes.load(std::memory_order_relaxed);
+    uint64_t heap_allocs = heap_allocations();
+    uint64_t turn = g_turn.load(std::memory_order_relaxed);
+    if (turn > 0) {
+        state.last.turn = turn;
+        state.last.frame_allocations = frame_allocs - state.frame_allocations_at_start;
+        state.last.frame_bytes = frame_bytes - state.frame_bytes_at_start;
+        state.last.heap_allocations = heap_allocs - state.heap_allocations_at_start;
+        static metrics::Histogram &heap_hist =
+            metrics::histogram("turn_heap_allocations", "Heap allocations made during one turn.", false);
+        static metrics::Histogram &frame_hist =
+            metrics::histogram("turn_frame_allocations", "Frame allocator allocations made during one turn.", false);
+        heap_hist.record(state.last.heap_allocations);
+        frame_hist.record(state.last.frame_allocations);
+        // Registering the histograms above may itself allocate.
+        heap_allocs = heap_allocations();
+    }
+    state.frame_allocations_at_start = frame_allocs;
+    state.frame_bytes_at_start = frame_bytes;
+    state.heap_allocations_at_start = heap_allocs;
+    g_turn.store(turn + 1, std::memory_order_release);
+}
+
+uint64_t current_turn() {
+    return g_turn.load(std::memory_order_acquire);
+}
+
+TurnStats last_turn() {
+    return turn_state().last;
+}
+
+FrameArena &arena() {
+    thread_local FrameArena local;
+    uint64_t turn = g_turn.load(std::memory_order_acquire);
+    if (local.turn_ != turn) {
+        local.reset();
+        local.turn_ = turn;
+    }
+    return local;
+}
+
+} // namespace frame
@@ -0,0 +1,249 @@
+/*
+ * Overmap hordes declared in horde.h.
+ */
+
+#include "horde.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <memory_resource>
+
+#include "frame_allocator.h"
+#include "memory_tracker.h"
+#include "metrics.h"
+#include "profiler.h"
+#include "simulation.h"
+
+namespace {
+
+constexpr uint64_t kHordeStream = 0x3c5a9e7f12d4b861ULL;
+/** Random tiles tried per horde while looking for a city to start in. */
+constexpr int kCityTries = 16;
+/** Tiles along each side of an overmap tile. */
+constexpr int kOmtTiles = kSubmapsPerOmt * kSubmapSize;
+
+metrics::Counter &expanded_total() {
+    static metrics::Counter &counter =
+        metrics::counter("hordes_expanded_total", "Hordes expanded into monsters on entering the active area.");
+    return counter;
+}
+
+metrics::Counter &collapsed_total() {
+    static metrics::Counter &counter =
+        metrics::counter("hordes_collapsed_total", "Hordes collapsed onto the overmap on leaving the active area.");
+    return counter;
+}
+
+int sign(int x) {
+    return (x > 0) - (x < 0);
+}
+
+/** Whether overmap tile `omt` covers any submap within `radius` of `center`. */
+bool reaches(Point omt, Point center, int radius) {
+    const int left = omt.x * kSubmapsPerOmt;
+    const int top = omt.y * kSubmapsPerOmt;
+    return left + kSubmapsPerOmt - 1 >= center.x - radius && left <= center.x + radius &&
+           top + kSubmapsPerOmt - 1 >= center.y - radius && top <= center.y + radius;
+}
+
+/** A destination within kHordeRoam tiles of `from`. */
+Point roam(Point from, Rng &rng) {
+    const uint32_t span = 2 * kHordeRoam + 1;
+    return Point{from.x + static_cast<int>(rng.below(span)) - kHordeRoam,
+                 from.y + static_cast<int>(rng.below(span)) - kHordeRoam};
+}
+
+} // namespace
+
+size_t Horde::size() const {
+    if (expanded) return monsters.size();
+    size_t n = 0;
+    for (const HordeMember &member : members) n += member.count;
+    return n;
+}
+
+size_t Hordes::populate(const Overmap &overmap, const MonsterGroup &group, size_t count, int min_size, int max_size,
+                        uint64_t seed) {
+    memory::TagScope tag(memory::Tag::world);
+    // New hordes may already be in the active area; check on the next update.
+    radius_ = -1;
+    Rng rng(Rng::stream_seed(seed ^ kHordeStream, overmap.pos().x, overmap.pos().y));
+    min_size = std::max(min_size, 1);
+    max_size = std::max(max_size, min_size);
+    // Monsters of each type drawn for the horde being made.
+    std::pmr::vector<uint32_t> counts(group.monsters.size(), frame::resource());
+    size_t added = 0;
+    hordes_.reserve(hordes_.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+        Point local;
+        for (int t = 0; t < kCityTries; ++t) {
+            local = Point{static_cast<int>(rng.below(kOvermapSize)), static_cast<int>(rng.below(kOvermapSize))};
+            if (overmap.terrain(local.x, local.y) == OvermapTerrain::city) break;
+        }
+        Horde &horde = hordes_.emplace_back();
+        horde.omt = Point{overmap.pos().x * kOvermapSize + local.x, overmap.pos().y * kOvermapSize + local.y};
+        horde.destination = roam(horde.omt, rng);
+        int size = min_size + static_cast<int>(rng.below(static_cast<uint32_t>(max_size - min_size + 1)));
+        std::fill(counts.begin(), counts.end(), 0);
+        for (int m = 0; m < size; ++m) ++counts[group.sample(rng)];
+        for (size_t e = 0; e < counts.size(); ++e) {
+            if (counts[e]) horde.members.push_back(HordeMember{group.monsters[e], counts[e]});
+        }
+        added += static_cast<size_t>(size);
+    }
+    return added;
+}
+
+HordeStats Hordes::update(Map &map, Point center, int radius, uint64_t turn, uint64_t seed) {
+    HordeStats stats;
+    const uint64_t steps = turn > moved_ ? turn / kHordeMoveInterval - moved_ / kHordeMoveInterval : 0;
+    moved_ = std::max(moved_, turn);
+    if (steps == 0 && center == center_ && radius == radius_) return stats;
+    PROFILE_SCOPE("hordes.update");
+    center_ = center;
+    radius_ = radius;
+    Rng rng(Rng::stream_seed(seed ^ kHordeStream ^ turn, 0, 0));
+    for (size_t i = 0; i < hordes_.size();) {
+        Horde &horde = hordes_[i];
+        if (horde.expanded) {
+            // Collapse once every monster has left the active area and
+            // the submap of margin around it.
+            bool near = false;
+            for (MonsterHandle h : horde.monsters) {
+                const MonsterInstance *m = monster_pool().get(h);
+                if (!m) continue;
+                Point sm = submap_of(m->pos);
+                if (std::max(std::abs(sm.x - center.x), std::abs(sm.y - center.y)) <= radius + 1) {
+                    near = true;
+                    break;
+                }
+            }
+            if (near) {
+                ++i;
+                continue;
+            }
+            stats.gathered += collapse(map, horde);
+            ++stats.collapsed;
+            if (horde.members.empty()) {
+                // Nothing survived; the horde is gone.
+                if (&horde != &hordes_.back()) horde = std::move(hordes_.back());
+                hordes_.pop_back();
+                continue;
+            }
+            // Its tile may still touch the active area; it is looked at
+            // again after its next step rather than expanded straight back.
+            ++i;
+            continue;
+        }
+        for (uint64_t s = 0; s < steps; ++s) step(horde, rng);
+        stats.steps += steps;
+        if (reaches(horde.omt, center, radius)) {
+            stats.placed += expand(map, horde, turn, seed, rng);
+            ++stats.expanded;
+        }
+        ++i;
+    }
+    if (stats.expanded) expanded_total().add(stats.expanded);
+    if (stats.collapsed) collapsed_total().add(stats.collapsed);
+    return stats;
+}
+
+uint64_t Hordes::quiet_turns(Point center, int radius, uint64_t now) const {
+    // Submaps between the horde's tile and the active area, along the
+    // axis where the gap is widest; a step closes kSubmapsPerOmt of it.
+    auto gap = [](int first, int middle, int radius) {
+        return std::max({0, middle - radius - (first + kSubmapsPerOmt - 1), first - (middle + radius)});
+    };
+    uint64_t steps = UINT64_MAX;
+    for (const Horde &horde : hordes_) {
+        if (horde.expanded) continue;
+        int submaps = std::max(gap(horde.omt.x * kSubmapsPerOmt, center.x, radius),
+                               gap(horde.omt.y * kSubmapsPerOmt, center.y, radius));
+        // A horde already in reach expands on the next update that moves
+        // the hordes, the same as one a step away.
+        steps = std::min(steps, std::max<uint64_t>((submaps + kSubmapsPerOmt - 1) / kSubmapsPerOmt, 1));
+    }
+    if (steps == UINT64_MAX) return steps;
+    return next_step(now) + (steps - 1) * kHordeMoveInterval - now;
+}
+
+size_t Hordes::monster_count() const {
+    size_t n = 0;
+    for (const Horde &horde : hordes_) n += horde.size();
+    return n;
+}
+
+size_t Hordes::bytes_reserved() const {
+    size_t bytes = hordes_.capacity() * sizeof(Horde);
+    for (const Horde &horde : hordes_) {
+        bytes += horde.members.capacity() * sizeof(HordeMember) + horde.monsters.capacity() * sizeof(MonsterHandle);
+    }
+    return bytes;
+}
+
+void Hordes::step(Horde &horde, Rng &rng) {
+    if (horde.omt == horde.destination) horde.destination = roam(horde.omt, rng);
+    horde.omt.x += sign(horde.destination.x - horde.omt.x);
+    horde.omt.y += sign(horde.destination.y - horde.omt.y);
+}
+
+size_t Hordes::expand(Map &map, Horde &horde, uint64_t turn, uint64_t seed, Rng &rng) {
+    memory::TagScope tag(memory::Tag::world);
+    const Point first{horde.omt.x * kSubmapsPerOmt, horde.omt.y * kSubmapsPerOmt};
+    // Bring the submaps up to date before anyone arrives, so that the
+    // newcomers are not caught up over turns before they were there.
+    for (int y = 0; y < kSubmapsPerOmt; ++y) {
+        for (int x = 0; x < kSubmapsPerOmt; ++x) {
+            catch_up(map, map.submap(Point{first.x + x, first.y + y}), turn, seed);
+        }
+    }
+    const Point corner{first.x * kSubmapSize, first.y * kSubmapSize};
+    horde.monsters.reserve(horde.size());
+    for (const HordeMember &member : horde.members) {
+        for (uint32_t n = 0; n < member.count; ++n) {
+            Point pos{corner.x + static_cast<int>(rng.below(kOmtTiles)),
+                      corner.y + static_cast<int>(rng.below(kOmtTiles))};
+            MonsterHandle h = spawn_monster(*member.type, pos, turn);
+            map.submap(submap_of(pos)).add_monster(h);
+            horde.monsters.push_back(h);
+        }
+    }
+    horde.members.clear();
+    horde.expanded = true;
+    return horde.monsters.size();
+}
+
+size_t Hordes::collapse(Map &map, Horde &horde) {
+    memory::TagScope tag(memory::Tag::world);
+    // The horde regroups on the overmap tile of its members' average
+    // position; monsters killed while it was expanded are left out.
+    double sum_x = 0;
+    double sum_y = 0;
+    size_t gathered = 0;
+    for (MonsterHandle h : horde.monsters) {
+        const MonsterInstance *m = monster_pool().get(h);
+        if (!m) continue;
+        sum_x += m->pos.x;
+        sum_y += m->pos.y;
+        auto member = std::find_if(horde.members.begin(), horde.members.end(),
+                                   [m](const HordeMember &e) { return e.type == m->type; });
+        if (member != horde.members.end()) {
+            ++member->count;
+        } else {
+            horde.members.push_back(HordeMember{m->type, 1});
+        }
+        if (Submap *sm = map.find(submap_of(m->pos))) sm->remove_monster(h);
+        monster_pool().destroy(h);
+        ++gathered;
+    }
+    horde.monsters.clear();
+    horde.monsters.shrink_to_fit();
+    horde.expanded = false;
+    if (gathered) {
+        Point tile{static_cast<int>(std::floor(sum_x / static_cast<double>(gathered))),
+                   static_cast<int>(std::floor(sum_y / static_cast<double>(gathered)))};
+        horde.omt = omt_of(submap_of(tile));
+    }
+    return gathered;
+}
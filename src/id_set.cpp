@@ -0,0 +1,43 @@
+/*
+ * Vocabulary implementation for id_set.h.
+ */
+
+#include "id_set.h"
+
+#include <iostream>
+
+uint32_t Vocabulary::intern(std::string_view name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = ids_.find(std::string(name));
+    if (it != ids_.end()) {
+        return it->second;
+    }
+    if (names_.size() >= capacity_) {
+        if (!overflow_reported_) {
+            std::cerr << "Too many " << what_ << " (limit " << capacity_ << "); ignoring '" << name << "'."
+                      << std::endl;
+            overflow_reported_ = true;
+        }
+        return kInvalid;
+    }
+    uint32_t id = static_cast<uint32_t>(names_.size());
+    names_.emplace_back(name);
+    ids_.emplace(names_.back(), id);
+    return id;
+}
+
+uint32_t Vocabulary::find(std::string_view name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = ids_.find(std::string(name));
+    return it != ids_.end() ? it->second : kInvalid;
+}
+
+std::string Vocabulary::name(uint32_t id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return id < names_.size() ? names_[id] : std::string();
+}
+
+size_t Vocabulary::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return names_.size();
+}
@@ -0,0 +1,42 @@
+/*
+ * Instance pools declared in instances.h.
+ */
+
+#include "instances.h"
+
+#include "memory_tracker.h"
+
+ItemHandle spawn_item(const Item &type, uint64_t turn) {
+    // Pools only allocate when they grow a chunk.
+    memory::TagScope tag(memory::Tag::world);
+    return item_pool().create(ItemInstance{&type, turn});
+}
+
+MonsterHandle spawn_monster(const Monster &type, Point pos, uint64_t turn) {
+    memory::TagScope tag(memory::Tag::world);
+    return monster_pool().create(MonsterInstance{&type, type.hp, pos, turn});
+}
+
+std::string_view freshness_label(ItemHandle h, uint64_t now) {
+    const ItemInstance *item = item_pool().get(h);
+    if (!item) return {};
+    double r = rot(*item, now);
+    return r >= 1 ? " (rotten)" : r >= 0.9 ? " (old)" : "";
+}
+
+const ItemHandle *find_handle(Span<const ItemHandle> items, const Id &id) {
+    for (const ItemHandle &h : items) {
+        const Item *type = item_type(h);
+        if (type && type->id == id) {
+            return &h;
+        }
+    }
+    return nullptr;
+}
+
+Footprint footprint(const std::vector<ItemHandle> &items) {
+    // Handles own nothing; the instances live in item_pool().
+    Footprint fp;
+    fp.object_bytes = items.capacity() * sizeof(ItemHandle);
+    return fp;
+}
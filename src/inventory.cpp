@@ -0,0 +1,234 @@
+/*
+ * Implementation of the nested inventory declared in inventory.h.
+ */
+
+#include "inventory.h"
+
+#include <algorithm>
+
+#include "memory_tracker.h"
+
+Inventory::Inventory(int64_t max_weight, int64_t max_volume) {
+    nodes_.emplace_back();
+    handles_.emplace_back();
+    types_.push_back(nullptr);
+    Node &root = nodes_[kRoot];
+    root.kind = Kind::root;
+    root.max_weight = max_weight;
+    root.max_volume = max_volume;
+}
+
+bool Inventory::fits(const Item &type, NodeId pocket) const {
+    const Node &p = nodes_[pocket];
+    if (p.volume + type.volume > p.max_volume) {
+        return false;
+    }
+    for (NodeId a = pocket; a != kNone; a = nodes_[a].parent) {
+        const Node &n = nodes_[a];
+        if (n.kind != Kind::item && n.weight + type.weight > n.max_weight) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Inventory::NodeId Inventory::find_space(const Item &type) const {
+    // Everything counts against the root's weight limit, so an item too
+    // heavy for it fits nowhere.
+    const Node &root = nodes_[kRoot];
+    if (root.weight + type.weight > root.max_weight) {
+        return kNone;
+    }
+    for (NodeId p : pockets_) {
+        if (fits(type, p)) {
+            return p;
+        }
+    }
+    return fits(type, kRoot) ? kRoot : kNone;
+}
+
+Inventory::NodeId Inventory::allocate(Kind kind, NodeId parent) {
+    NodeId n;
+    if (!free_.empty()) {
+        n = free_.back();
+        free_.pop_back();
+        nodes_[n] = Node();
+    } else {
+        n = static_cast<NodeId>(nodes_.size());
+        nodes_.emplace_back();
+        handles_.emplace_back();
+        types_.push_back(nullptr);
+    }
+    Node &node = nodes_[n];
+    node.kind = kind;
+    node.parent = parent;
+    // Append to the parent's children so listings keep insertion order.
+    Node &p = nodes_[parent];
+    node.prev_sibling = p.last_child;
+    if (p.last_child != kNone) {
+        nodes_[p.last_child].next_sibling = n;
+    } else {
+        p.first_child = n;
+    }
+    p.last_child = n;
+    return n;
+}
+
+Inventory::NodeId Inventory::insert(ItemHandle item, NodeId pocket) {
+    memory::TagScope tag(memory::Tag::inventory);
+    const Item *type = item_type(item);
+    int64_t weight = type ? type->weight : 0;
+    int64_t volume = type ? type->volume : 0;
+    NodeId n = allocate(Kind::item, pocket);
+    handles_[n] = item;
+    types_[n] = type;
+    nodes_[n].weight = weight;
+    nodes_[n].count = 1;
+    if (type) {
+        for (const Pocket &spec : type->pockets) {
+            NodeId p = allocate(Kind::pocket, n);
+            nodes_[p].max_weight = spec.max_weight;
+            nodes_[p].max_volume = spec.max_volume;
+            pockets_.push_back(p);
+        }
+    }
+    nodes_[pocket].volume += volume;
+    for (NodeId a = pocket; a != kNone; a = nodes_[a].parent) {
+        nodes_[a].weight += weight;
+        nodes_[a].count += 1;
+    }
+    index_insert(n);
+    return n;
+}
+
+void Inventory::release(NodeId n, std::vector<ItemHandle> &contents) {
+    for (NodeId c = nodes_[n].first_child; c != kNone;) {
+        NodeId next = nodes_[c].next_sibling;
+        if (nodes_[c].kind == Kind::item) {
+            contents.push_back(handles_[c]);
+            index_remove(c);
+        } else {
+            pockets_.erase(std::find(pockets_.begin(), pockets_.end(), c));
+        }
+        release(c, contents);
+        c = next;
+    }
+    nodes_[n] = Node();
+    handles_[n] = ItemHandle();
+    types_[n] = nullptr;
+    free_.push_back(n);
+}
+
+void Inventory::remove(NodeId node, std::vector<ItemHandle> &contents) {
+    Node &n = nodes_[node];
+    NodeId pocket = n.parent;
+    int64_t weight = n.weight;
+    uint32_t count = n.count;
+    const Item *type = types_[node];
+    nodes_[pocket].volume -= type ? type->volume : 0;
+    for (NodeId a = pocket; a != kNone; a = nodes_[a].parent) {
+        nodes_[a].weight -= weight;
+        nodes_[a].count -= count;
+    }
+    // Unlink from the parent's children.
+    Node &p = nodes_[pocket];
+    if (n.prev_sibling != kNone) {
+        nodes_[n.prev_sibling].next_sibling = n.next_sibling;
+    } else {
+        p.first_child = n.next_sibling;
+    }
+    if (n.next_sibling != kNone) {
+        nodes_[n.next_sibling].prev_sibling = n.prev_sibling;
+    } else {
+        p.last_child = n.prev_sibling;
+    }
+    memory::TagScope tag(memory::Tag::inventory);
+    index_remove(node);
+    release(node, contents);
+}
+
+Inventory::NodeId Inventory::find(const Id &id) const {
+    for (NodeId n = 0; n < types_.size(); ++n) {
+        const Item *type = types_[n];
+        if (type && type->id == id) {
+            return n;
+        }
+    }
+    return kNone;
+}
+
+void Inventory::clear() {
+    Node root = nodes_[kRoot];
+    nodes_.clear();
+    handles_.assign(1, ItemHandle());
+    types_.assign(1, nullptr);
+    free_.clear();
+    categories_.clear();
+    materials_.clear();
+    flags_.clear();
+    pockets_.clear();
+    root.first_child = root.last_child = kNone;
+    root.count = 0;
+    root.weight = root.volume = 0;
+    nodes_.push_back(root);
+}
+
+template <typename F>
+void Inventory::for_each_key(const Item &type, F &&f) {
+    if (!type.category.empty()) {
+        f(categories_[Id(type.category)]);
+    }
+    // Lists for materials and flags are created on first use.
+    if (materials_.empty()) materials_.resize(MaterialSet::kBits);
+    if (flags_.empty()) flags_.resize(FlagSet::kBits);
+    type.materials.for_each([&](size_t id) { f(materials_[id]); });
+    type.flags.for_each([&](size_t id) { f(flags_[id]); });
+}
+
+namespace {
+
+/** Order index entries by item name, then by node for a total order. */
+struct ByName {
+    const std::vector<const Item *> &types;
+    bool operator()(Inventory::NodeId a, Inventory::NodeId b) const {
+        int c = types[a]->name.compare(types[b]->name);
+        return c < 0 || (c == 0 && a < b);
+    }
+};
+
+} // namespace
+
+void Inventory::index_insert(NodeId n) {
+    const Item *type = types_[n];
+    if (!type) return;
+    for_each_key(*type, [&](std::vector<NodeId> &nodes) {
+        nodes.insert(std::upper_bound(nodes.begin(), nodes.end(), n, ByName{types_}), n);
+    });
+}
+
+void Inventory::index_remove(NodeId n) {
+    // Empty lists are kept: the set of keys is small, and reusing them
+    // avoids reallocating when an item comes straight back.
+    const Item *type = types_[n];
+    if (!type) return;
+    for_each_key(*type, [&](std::vector<NodeId> &nodes) {
+        auto pos = std::lower_bound(nodes.begin(), nodes.end(), n, ByName{types_});
+        if (pos != nodes.end() && *pos == n) {
+            nodes.erase(pos);
+        }
+    });
+}
+
+Span<const Inventory::NodeId> Inventory::with(Facet facet, const Id &key) const {
+    const std::vector<NodeId> *nodes = nullptr;
+    if (facet == Facet::category) {
+        auto it = categories_.find(key);
+        nodes = it != categories_.end() ? &it->second : nullptr;
+    } else {
+        Vocabulary &names = facet == Facet::material ? material_names() : flag_names();
+        const std::vector<std::vector<NodeId>> &lists = facet == Facet::material ? materials_ : flags_;
+        uint32_t id = names.find(key.view());
+        nodes = id < lists.size() ? &lists[id] : nullptr;
+    }
+    return nodes ? Span<const NodeId>(*nodes) : Span<const NodeId>();
+}
@@ -0,0 +1,211 @@
+/*
+ * Item group loading, compilation and bulk spawning for item_group.h.
+ */
+
+#include "item_group.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include "memory_tracker.h"
+#include "metrics.h"
+#include "profiler.h"
+
+namespace {
+
+/** A group as written in the file, before nested groups are resolved. */
+struct RawEntry {
+    Id id;
+    bool group = false;
+    double weight = 0;
+};
+
+struct RawGroup {
+    Id id;
+    std::vector<RawEntry> entries;
+};
+
+/** Flattened distribution of a group: (index into the item table, probability). */
+using Distribution = std::vector<std::pair<uint32_t, double>>;
+
+class Compiler {
+public:
+    Compiler(const std::vector<RawGroup> &raw, const ItemTable &items) : raw_(raw), items_(items) {
+        flat_.resize(raw.size());
+        state_.assign(raw.size(), State::pending);
+        for (size_t g = 0; g < raw.size(); ++g) index_.emplace(raw[g].id, g);
+    }
+
+    /** Distribution of group `g`, flattening its nested groups first. */
+    const Distribution &flatten(size_t g) {
+        if (state_[g] != State::pending) return flat_[g];
+        state_[g] = State::visiting;
+        const RawGroup &group = raw_[g];
+        double total = 0;
+        for (const RawEntry &e : group.entries) {
+            if (e.weight > 0) total += e.weight;
+        }
+        Distribution dist;
+        for (const RawEntry &e : group.entries) {
+            if (!(e.weight > 0)) continue;
+            double share = e.weight / total;
+            if (!e.group) {
+                const Item *item = find_item(items_, e.id);
+                if (!item) {
+                    std::cerr << "Item group '" << group.id << "' references unknown item '" << e.id << "'."
+                              << std::endl;
+                    continue;
+                }
+                dist.emplace_back(static_cast<uint32_t>(item - items_.data()), share);
+                continue;
+            }
+            auto it = index_.find(e.id);
+            if (it == index_.end()) {
+                std::cerr << "Item group '" << group.id << "' references unknown group '" << e.id << "'."
+                          << std::endl;
+                continue;
+            }
+            if (state_[it->second] == State::visiting) {
+                std::cerr << "Item group '" << group.id << "' nests '" << e.id << "', which contains it."
+                          << std::endl;
+                continue;
+            }
+            for (const auto &[item, p] : flatten(it->second)) dist.emplace_back(item, share * p);
+        }
+        // Merge items reached through several entries, in table order
+        // so that samples do not depend on the order of the entries.
+        std::sort(dist.begin(), dist.end());
+        Distribution &merged = flat_[g];
+        for (const auto &entry : dist) {
+            if (!merged.empty() && merged.back().first == entry.first) {
+                merged.back().second += entry.second;
+            } else {
+                merged.push_back(entry);
+            }
+        }
+        // Skipped entries leave a gap; renormalize over what is left.
+        double sum = 0;
+        for (const auto &entry : merged) sum += entry.second;
+        for (auto &entry : merged) entry.second /= sum;
+        state_[g] = State::done;
+        return merged;
+    }
+
+private:
+    enum class State : uint8_t { pending, visiting, done };
+
+    const std::vector<RawGroup> &raw_;
+    const ItemTable &items_;
+    std::unordered_map<Id, size_t> index_;
+    std::vector<Distribution> flat_;
+    std::vector<State> state_;
+};
+
+} // namespace
+
+ItemGroupTable load_item_groups(const std::string &filename, const ItemTable &items) {
+    PROFILE_SCOPE("load.item_groups");
+    memory::TagScope tag(memory::Tag::content);
+    ItemGroupTable table;
+    std::ifstream f(filename);
+    if (!f) {
+        std::cerr << "Failed to open " << filename << std::endl;
+        return table;
+    }
+    std::vector<RawGroup> raw;
+    RawGroup current;
+    std::string line;
+    while (std::getline(f, line)) {
+        size_t pos = line.find_first_not_of(" \t");
+        if (pos == std::string::npos) continue;
+        std::string_view t = std::string_view(line).substr(pos);
+        std::string_view key;
+        size_t after_key = next_quoted(t, 0, key);
+        if (t[0] == '[' && after_key != std::string_view::npos) {
+            // [ "item", weight ]
+            size_t comma = t.find(',', after_key);
+            double weight = comma == std::string_view::npos ? 100 : std::strtod(t.data() + comma + 1, nullptr);
+            current.entries.push_back(RawEntry{table.strings().intern(key), false, weight});
+        } else if (t[0] == '{' && (key == "item" || key == "group")) {
+            // { "item": "id", "prob": weight } or { "group": ... }
+            std::string_view id;
+            if (next_quoted(t, after_key, id) != std::string_view::npos) {
+                current.entries.push_back(
+                    RawEntry{table.strings().intern(id), key == "group", number_after(t, "\"prob\"", 100)});
+            }
+        } else if (key == "id") {
+            std::string_view id;
+            if (next_quoted(t, after_key, id) != std::string_view::npos) current.id = table.strings().intern(id);
+        } else if (t[0] == '{') {
+            current = RawGroup();
+        } else if (t[0] == '}') {
+            if (!current.id.empty()) raw.push_back(std::move(current));
+            current = RawGroup();
+        }
+    }
+
+    Compiler compiler(raw, items);
+    std::vector<ItemGroup> groups;
+    std::vector<const Item *> types;
+    std::vector<double> probabilities;
+    std::vector<AliasColumn> columns;
+    for (size_t g = 0; g < raw.size(); ++g) {
+        const Distribution &dist = compiler.flatten(g);
+        if (dist.empty()) {
+            std::cerr << "Item group '" << raw[g].id << "' has no valid entries." << std::endl;
+            continue;
+        }
+        types.clear();
+        probabilities.clear();
+        for (const auto &[item, p] : dist) {
+            types.push_back(&items[item]);
+            probabilities.push_back(p);
+        }
+        build_alias_table(probabilities, columns);
+        ItemGroup group;
+        group.id = raw[g].id;
+        group.items = table.arena().copy_array(types.data(), types.size());
+        group.probabilities = table.arena().copy_array(probabilities.data(), probabilities.size());
+        group.table = AliasTable(table.arena().copy_array(columns.data(), columns.size()));
+        groups.push_back(group);
+    }
+    table.assign(groups);
+    metrics::counter("item_groups_loaded_total", "Item groups loaded from JSON.").add(table.size());
+    return table;
+}
+
+SpawnStats spawn_item_group(Map &map, const ItemGroup &group, Point first, Point last, double density,
+                            uint64_t turn, uint64_t seed) {
+    PROFILE_SCOPE("spawn.item_group");
+    SpawnStats stats;
+    if (group.table.empty() || !(density > 0)) return stats;
+    // Number of empty tiles before the next filled one follows the
+    // geometric distribution with success probability `density`.
+    double log_miss = density < 1 ? std::log1p(-density) : 0;
+    std::vector<TileItem> batch;
+    batch.reserve(kSubmapTiles);
+    for (int y = first.y; y <= last.y; ++y) {
+        for (int x = first.x; x <= last.x; ++x) {
+            Rng rng(Rng::stream_seed(seed, x, y));
+            auto skip = [&]() -> int {
+                if (log_miss == 0) return 0;
+                double gap = std::floor(std::log1p(-rng.uniform()) / log_miss);
+                return gap < kSubmapTiles ? static_cast<int>(gap) : kSubmapTiles;
+            };
+            batch.clear();
+            for (int t = skip(); t < kSubmapTiles; t += 1 + skip()) {
+                batch.push_back(TileItem{static_cast<uint16_t>(t), spawn_item(*group.sample(rng), turn)});
+            }
+            map.submap(Point{x, y}).add_items(batch);
+            stats.items += batch.size();
+            ++stats.submaps;
+        }
+    }
+    metrics::counter("items_spawned_total", "Item instances created by item group spawns.").add(stats.items);
+    return stats;
+}
@@ -0,0 +1,67 @@
+/*
+ * Implementation of the worker pool declared in jobs.h.
+ */
+
+#include "jobs.h"
+
+#include <algorithm>
+#include <string>
+
+#include "profiler.h"
+#include "trace.h"
+
+namespace jobs {
+
+Pool::Pool(unsigned threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        workers_.emplace_back([this, i]() { worker_loop(i); });
+    }
+}
+
+Pool::~Pool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+}
+
+void Pool::enqueue(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(job));
+    }
+    cv_.notify_one();
+}
+
+void Pool::worker_loop(unsigned index) {
+    trace::set_thread_name("worker " + std::to_string(index));
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            job = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        PROFILE_SCOPE("jobs.run");
+        job();
+    }
+}
+
+Pool &default_pool() {
+    static Pool pool;
+    return pool;
+}
+
+} // namespace jobs
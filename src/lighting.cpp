@@ -0,0 +1,259 @@
+/*
+ * Cached, incrementally updated lighting declared in lighting.h.
+ */
+
+#include "lighting.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "frame_allocator.h"
+#include "memory_tracker.h"
+#include "profiler.h"
+
+static_assert(kSubmapTiles % 16 == 0, "light grids are summed 16 tiles at a time");
+
+void add_light_scalar(LightGrid &dst, const LightGrid &src) {
+    for (int t = 0; t < kSubmapTiles; ++t) {
+        dst.level[t] = static_cast<uint8_t>(std::min(dst.level[t] + src.level[t], 255));
+    }
+}
+
+void add_light(LightGrid &dst, const LightGrid &src) {
+#if defined(__SSE2__)
+    for (int t = 0; t < kSubmapTiles; t += 16) {
+        __m128i *out = reinterpret_cast<__m128i *>(dst.level.data() + t);
+        __m128i in = _mm_load_si128(reinterpret_cast<const __m128i *>(src.level.data() + t));
+        _mm_store_si128(out, _mm_adds_epu8(_mm_load_si128(out), in));
+    }
+#else
+    add_light_scalar(dst, src);
+#endif
+}
+
+LightId Lighting::add(const LightSource &light) {
+    memory::TagScope tag(memory::Tag::world);
+    uint32_t n;
+    if (!free_.empty()) {
+        n = free_.back();
+        free_.pop_back();
+    } else {
+        n = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    Node &node = nodes_[n];
+    node.light = light;
+    node.live = true;
+    ++size_;
+    mark_dirty(n);
+    return LightId{n, node.generation};
+}
+
+bool Lighting::remove(LightId id) {
+    Node *node = this->node(id);
+    if (!node) return false;
+    // Its blocks are taken out of the submaps by the next update(),
+    // even if the node has been reused by then.
+    node->live = false;
+    ++node->generation;
+    mark_dirty(id.index);
+    free_.push_back(id.index);
+    --size_;
+    return true;
+}
+
+bool Lighting::move(LightId id, Point pos) {
+    Node *node = this->node(id);
+    if (!node) return false;
+    if (node->light.pos != pos) {
+        node->light.pos = pos;
+        mark_dirty(id.index);
+    }
+    return true;
+}
+
+const LightSource *Lighting::get(LightId id) const {
+    const Node *node = const_cast<Lighting *>(this)->node(id);
+    return node ? &node->light : nullptr;
+}
+
+void Lighting::terrain_changed(Point tile) {
+    auto it = submaps_.find(key(submap_of(tile)));
+    if (it == submaps_.end()) return;
+    for (uint32_t n : it->second.sources) {
+        const LightSource &light = nodes_[n].light;
+        if (std::max(std::abs(tile.x - light.pos.x), std::abs(tile.y - light.pos.y)) <= light.radius) mark_dirty(n);
+    }
+}
+
+size_t Lighting::update(const Map &map) {
+    PROFILE_SCOPE("lighting.update");
+    memory::TagScope tag(memory::Tag::world);
+    size_t recomputed = 0;
+    // Submaps whose sum needs rebuilding; only needed for this update.
+    std::pmr::vector<uint64_t> dirty_submaps(frame::resource());
+    for (uint32_t n : dirty_) {
+        Node &node = nodes_[n];
+        if (!node.dirty) continue;
+        node.dirty = false;
+        unlink(n, dirty_submaps);
+        if (!node.live) {
+            node.blocks.clear();
+            continue;
+        }
+        cast(n, map, dirty_submaps);
+        ++recomputed;
+    }
+    dirty_.clear();
+    for (uint64_t k : dirty_submaps) {
+        auto it = submaps_.find(k);
+        if (it == submaps_.end()) continue;
+        SubmapLight &sl = it->second;
+        sl.dirty = false;
+        if (sl.sources.empty()) {
+            submaps_.erase(it);
+            continue;
+        }
+        sl.light = LightGrid();
+        for (uint32_t n : sl.sources) {
+            for (const Block &block : nodes_[n].blocks) {
+                if (key(block.submap) == k) {
+                    add_light(sl.light, block.light);
+                    break;
+                }
+            }
+        }
+    }
+    return recomputed;
+}
+
+uint8_t Lighting::at(Point tile) const {
+    Point sm = submap_of(tile);
+    const LightGrid *light = grid(sm);
+    if (!light) return 0;
+    return light->level[(tile.y - sm.y * kSubmapSize) * kSubmapSize + (tile.x - sm.x * kSubmapSize)];
+}
+
+const LightGrid *Lighting::grid(Point submap) const {
+    auto it = submaps_.find(key(submap));
+    return it != submaps_.end() ? &it->second.light : nullptr;
+}
+
+size_t Lighting::bytes_reserved() const {
+    size_t bytes = nodes_.capacity() * sizeof(Node) + window_.capacity() + free_.capacity() * sizeof(uint32_t) +
+                   dirty_.capacity() * sizeof(uint32_t) + submaps_.bucket_count() * sizeof(void *);
+    for (const Node &node : nodes_) bytes += node.blocks.capacity() * sizeof(Block);
+    for (const auto &entry : submaps_) bytes += sizeof(entry) + entry.second.sources.capacity() * sizeof(uint32_t);
+    return bytes;
+}
+
+Lighting::Node *Lighting::node(LightId id) {
+    if (id.index >= nodes_.size()) return nullptr;
+    Node &node = nodes_[id.index];
+    return node.live && node.generation == id.generation ? &node : nullptr;
+}
+
+void Lighting::mark_dirty(uint32_t n) {
+    if (nodes_[n].dirty) return;
+    nodes_[n].dirty = true;
+    dirty_.push_back(n);
+}
+
+void Lighting::unlink(uint32_t n, std::pmr::vector<uint64_t> &dirty_submaps) {
+    for (const Block &block : nodes_[n].blocks) {
+        uint64_t k = key(block.submap);
+        auto it = submaps_.find(k);
+        if (it == submaps_.end()) continue;
+        std::vector<uint32_t> &sources = it->second.sources;
+        auto found = std::find(sources.begin(), sources.end(), n);
+        if (found != sources.end()) {
+            *found = sources.back();
+            sources.pop_back();
+        }
+        if (!it->second.dirty) {
+            it->second.dirty = true;
+            dirty_submaps.push_back(k);
+        }
+    }
+}
+
+void Lighting::cast(uint32_t n, const Map &map, std::pmr::vector<uint64_t> &dirty_submaps) {
+    Node &node = nodes_[n];
+    const LightSource &light = node.light;
+    const int r = std::max(light.radius, 0);
+    const int side = 2 * r + 1;
+    const Point lo{light.pos.x - r, light.pos.y - r};
+    const Point hi{light.pos.x + r, light.pos.y + r};
+    const Point first = submap_of(lo);
+    const Point last = submap_of(hi);
+    // Gather the opacity of the square around the source, one submap
+    // at a time, so rays test a flat array rather than looking submaps
+    // up tile by tile. Submaps that do not exist are open ground.
+    window_.assign(static_cast<size_t>(side) * side, 0);
+    for (int sy = first.y; sy <= last.y; ++sy) {
+        for (int sx = first.x; sx <= last.x; ++sx) {
+            const Submap *sm = map.find(Point{sx, sy});
+            if (!sm) continue;
+            const Point corner{sx * kSubmapSize, sy * kSubmapSize};
+            for (int y = std::max(lo.y, corner.y); y <= std::min(hi.y, corner.y + kSubmapSize - 1); ++y) {
+                for (int x = std::max(lo.x, corner.x); x <= std::min(hi.x, corner.x + kSubmapSize - 1); ++x) {
+                    window_[(y - lo.y) * side + (x - lo.x)] = sm->opaque(x - corner.x, y - corner.y);
+                }
+            }
+        }
+    }
+    // Whether the line from the source to (dx, dy) passes no opaque
+    // tile before reaching it (Bresenham).
+    auto visible = [&](int dx, int dy) {
+        const int adx = std::abs(dx);
+        const int ady = std::abs(dy);
+        const int step_x = dx < 0 ? -1 : 1;
+        const int step_y = dy < 0 ? -1 : 1;
+        int err = adx - ady;
+        int x = 0;
+        int y = 0;
+        while (true) {
+            int e2 = 2 * err;
+            if (e2 > -ady) {
+                err -= ady;
+                x += step_x;
+            }
+            if (e2 < adx) {
+                err += adx;
+                y += step_y;
+            }
+            if (x == dx && y == dy) return true;
+            if (window_[(y + r) * side + (x + r)]) return false;
+        }
+    };
+    node.blocks.clear();
+    for (int sy = first.y; sy <= last.y; ++sy) {
+        for (int sx = first.x; sx <= last.x; ++sx) {
+            Block &block = node.blocks.emplace_back();
+            block.submap = Point{sx, sy};
+            const Point corner{sx * kSubmapSize, sy * kSubmapSize};
+            for (int y = std::max(lo.y, corner.y); y <= std::min(hi.y, corner.y + kSubmapSize - 1); ++y) {
+                for (int x = std::max(lo.x, corner.x); x <= std::min(hi.x, corner.x + kSubmapSize - 1); ++x) {
+                    int dx = x - light.pos.x;
+                    int dy = y - light.pos.y;
+                    int d2 = dx * dx + dy * dy;
+                    if (d2 > r * r || ((dx || dy) && !visible(dx, dy))) continue;
+                    double falloff = 1.0 - std::sqrt(static_cast<double>(d2)) / (r + 1);
+                    block.light.level[(y - corner.y) * kSubmapSize + (x - corner.x)] =
+                        static_cast<uint8_t>(std::clamp(static_cast<int>(light.brightness * falloff), 0, 255));
+                }
+            }
+            SubmapLight &sl = submaps_[key(block.submap)];
+            sl.sources.push_back(n);
+            if (!sl.dirty) {
+                sl.dirty = true;
+                dirty_submaps.push_back(key(block.submap));
+            }
+        }
+    }
+}
@@ -0,0 +1,55 @@
+/*
+ * Turn budget and level-of-detail control declared in lod.h.
+ */
+
+#include "lod.h"
+
+#include <algorithm>
+
+#include "metrics.h"
+
+namespace {
+
+/** Weight of the newest turn in the moving average. */
+constexpr double kSmoothing = 0.2;
+
+metrics::Gauge &level_gauge() {
+    static metrics::Gauge &gauge = metrics::gauge("sim_lod_level", "Level of detail of the turn simulation.");
+    return gauge;
+}
+
+metrics::Histogram &turn_seconds() {
+    static metrics::Histogram &histogram = metrics::histogram("sim_turn_seconds", "Time to simulate one turn.");
+    return histogram;
+}
+
+} // namespace
+
+void LodController::record(double turn_us) {
+    turn_seconds().record(static_cast<uint64_t>(std::max(turn_us, 0.0) * 1000.0));
+    last_us_ = turn_us;
+    average_us_ = recorded_ == 0 ? turn_us : average_us_ + kSmoothing * (turn_us - average_us_);
+    ++recorded_;
+    ++turns_[level_];
+    ++held_;
+    if (fixed_ || held_ < kSettleTurns) return;
+    int next = level_;
+    if (average_us_ > budget_us_ && level_ < kMaxLod) {
+        ++next;
+    } else if (average_us_ < budget_us_ * kLowerShare && level_ > 0) {
+        --next;
+    }
+    if (next != level_) {
+        level_ = next;
+        held_ = 0;
+        level_gauge().set(level_);
+    }
+}
+
+void LodController::fix(int level) {
+    fixed_ = level >= 0;
+    if (!fixed_) return;
+    level_ = std::min(level, kMaxLod);
+    held_ = 0;
+    level_gauge().set(level_);
+}
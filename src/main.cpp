@@ -9,311 +9,231 @@
  * external JSON library and keeps the example self‑contained.
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <vector>
-#include <filesystem>
 #include <sstream>
-#include <random>
+#include <memory>
 
-struct Item {
-    std::string id;
-    std::string name;
-};
+#include "combat.h"
+#include "content.h"
+#include "crafting.h"
+#include "frame_allocator.h"
+#include "horde.h"
+#include "instances.h"
+#include "item_group.h"
+#include "jobs.h"
+#include "lighting.h"
+#include "lod.h"
+#include "map.h"
+#include "memory_tracker.h"
+#include "metrics.h"
+#include "monster_group.h"
+#include "overmap.h"
+#include "player.h"
+#include "profiler.h"
+#include "simulation.h"
+#include "timer_wheel.h"
+#include "trace.h"
 
-/**
- * Structure representing a monster definition loaded from JSON.
- * Monsters have an identifier, a display name, hit points (hp) and
- * simple combat attributes.  This struct is intentionally simple and
- * supports only the fields parsed by load_monsters() below.
- */
-struct Monster {
-    std::string id;
-    std::string name;
-    int hp = 0;
-    int melee_dice = 0;
-    int melee_dice_sides = 0;
-    int armor = 0;
-};
-
-/**
- * Simple Player structure that holds an inventory of Item objects.
- * The player can pick up items from the world and drop them back.
- */
-struct Player {
-    std::vector<Item> inventory;
-
-    /**
-     * Hit points representing the player's health in combat. The player
-     * starts with 100 hp and loses hp when taking damage from monsters.
-     */
-    int hp = 100;
-
-    /**
-     * Add an item to the player's inventory.
-     */
-    void add_item(const Item &item) {
-        inventory.push_back(item);
-    }
-
-    /**
-     * Remove an item by id from the player's inventory.
-     * Returns true if removed, false if not found.
-     */
-    bool remove_item(const std::string &item_id, Item &out_item) {
-        for (auto it = inventory.begin(); it != inventory.end(); ++it) {
-            if (it->id == item_id) {
-                out_item = *it;
-                inventory.erase(it);
-                return true;
+int main(int argc, char **argv) {
+    // Command line options. --profile-report dumps aggregated scope
+    // timings to stdout at exit; --profile-report=<file> writes them
+    // to a file instead. --trace=<file> records spans from startup and
+    // writes them as Chrome trace JSON at exit. --metrics-file=<file>
+    // dumps metrics in Prometheus text format every
+    // --metrics-interval=<seconds> (default 10) and at exit.
+    bool profile_report = false;
+    std::string metrics_path;
+    int metrics_interval = 10;
+    std::string profile_report_path;
+    std::string trace_path;
+    for (int i = 1; i < argc; ++i) {
+        std::string opt = argv[i];
+        if (opt == "--profile-report") {
+            profile_report = true;
+        } else if (opt.rfind("--profile-report=", 0) == 0) {
+            profile_report = true;
+            profile_report_path = opt.substr(std::string("--profile-report=").size());
+        } else if (opt.rfind("--trace=", 0) == 0) {
+            trace_path = opt.substr(std::string("--trace=").size());
+        } else if (opt.rfind("--metrics-file=", 0) == 0) {
+            metrics_path = opt.substr(std::string("--metrics-file=").size());
+        } else if (opt.rfind("--metrics-interval=", 0) == 0) {
+            try {
+                metrics_interval = std::stoi(opt.substr(std::string("--metrics-interval=").size()));
+            } catch (...) {
+                metrics_interval = 0;
             }
-        }
-        return false;
-    }
-};
-
-/**
- * Recipe structure representing a craftable recipe loaded from JSON.
- * Each recipe has an id, a resulting item id, and a list of
- * component requirements (item id and quantity).
- */
-struct Recipe {
-    std::string id;
-    std::string result;
-    std::vector<std::pair<std::string, int>> components;
-};
-
-/**
- * Load recipes from a JSON file. This parser is simplistic and only
- * extracts the "id", "result", and first level of components
- * (assumes each component entry is a two‑element array [ [ "id", qty ] ]).
- */
-std::vector<Recipe> load_recipes(const std::string &filename) {
-    std::vector<Recipe> recipes;
-    std::ifstream f(filename);
-    if (!f) {
-        std::cerr << "Failed to open " << filename << std::endl;
-        return recipes;
-    }
-    Recipe current;
-    std::string line;
-    while (std::getline(f, line)) {
-        // Trim leading spaces
-        auto pos = line.find_first_not_of(" \t");
-        if (pos == std::string::npos) continue;
-        std::string trimmed = line.substr(pos);
-        // New recipe when encountering '{'
-        if (trimmed.find("{") != std::string::npos) {
-            current = Recipe();
-        }
-        // Parse id
-        auto id_pos = trimmed.find("\"id\"");
-        if (id_pos != std::string::npos) {
-            auto colon = trimmed.find(':', id_pos);
-            auto q1 = trimmed.find('"', colon + 1);
-            auto q2 = trimmed.find('"', q1 + 1);
-            if (q1 != std::string::npos && q2 != std::string::npos) {
-                current.id = trimmed.substr(q1 + 1, q2 - q1 - 1);
-            }
-        }
-        // Parse result
-        auto res_pos = trimmed.find("\"result\"");
-        if (res_pos != std::string::npos) {
-            auto colon = trimmed.find(':', res_pos);
-            auto q1 = trimmed.find('"', colon + 1);
-            auto q2 = trimmed.find('"', q1 + 1);
-            if (q1 != std::string::npos && q2 != std::string::npos) {
-                current.result = trimmed.substr(q1 + 1, q2 - q1 - 1);
-            }
-        }
-        // Parse components entry lines like [ [ "id", qty ] ]
-        // We'll look for two quotes and a comma separating quantity
-        if (trimmed.find("[ [") != std::string::npos) {
-            auto q1 = trimmed.find('"');
-            auto q2 = trimmed.find('"', q1 + 1);
-            if (q1 != std::string::npos && q2 != std::string::npos) {
-                std::string comp_id = trimmed.substr(q1 + 1, q2 - q1 - 1);
-                // Find quantity after comma
-                auto comma = trimmed.find(',', q2);
-                if (comma != std::string::npos) {
-                    std::string qty_str = trimmed.substr(comma + 1);
-                    int qty = std::stoi(qty_str);
-                    current.components.emplace_back(comp_id, qty);
-                }
-            }
-        }
-        // When encountering '}', push current recipe if it has id and result
-        if (trimmed.find("}") != std::string::npos) {
-            if (!current.id.empty() && !current.result.empty()) {
-                recipes.push_back(current);
-                current = Recipe();
+            if (metrics_interval <= 0) {
+                std::cerr << "Invalid metrics interval in '" << opt << "'." << std::endl;
+                return 1;
             }
+        } else {
+            std::cerr << "Unknown option '" << opt << "'." << std::endl;
+            return 1;
         }
     }
-    return recipes;
-}
-
-/**
- * Load monsters from a JSON file. This parser reads each monster
- * definition and extracts basic combat attributes. It is line‑based
- * and similar to load_items and load_recipes, so it should be easy
- * to extend if more fields are needed. Each monster requires an
- * "id" field, a "name" object with a "str" subfield, and an "hp"
- * field. Optional fields include "melee_dice", "melee_dice_sides"
- * and "armor".
- */
-std::vector<Monster> load_monsters(const std::string &filename) {
-    std::vector<Monster> monsters;
-    std::ifstream f(filename);
-    if (!f) {
-        std::cerr << "Failed to open " << filename << std::endl;
-        return monsters;
+    trace::set_thread_name("main");
+    if (!trace_path.empty()) {
+        trace::start();
     }
-    Monster current;
-    bool in_object = false;
-    std::string line;
-    auto trim = [](const std::string &s) {
-        size_t start = s.find_first_not_of(" \t\n\r");
-        size_t end = s.find_last_not_of(" \t\n\r");
-        if (start == std::string::npos || end == std::string::npos) return std::string();
-        return s.substr(start, end - start + 1);
-    };
-    auto extract_string_value = [&](const std::string &s) -> std::string {
-        auto colon = s.find(':');
-        if (colon == std::string::npos) return "";
-        std::string value = s.substr(colon + 1);
-        // remove commas
-        value.erase(std::remove(value.begin(), value.end(), ','), value.end());
-        // find first and last quote
-        size_t q1 = value.find('"');
-        size_t q2 = value.find_last_of('"');
-        if (q1 != std::string::npos && q2 != std::string::npos && q2 > q1) {
-            return value.substr(q1 + 1, q2 - q1 - 1);
-        }
-        // fallback: trim
-        return trim(value);
-    };
-    auto extract_int_value = [&](const std::string &s) -> int {
-        auto colon = s.find(':');
-        if (colon == std::string::npos) return 0;
-        std::string value = s.substr(colon + 1);
-        value.erase(std::remove(value.begin(), value.end(), ','), value.end());
-        value.erase(0, value.find_first_not_of(" \t"));
-        try {
-            return std::stoi(value);
-        } catch (...) {
-            return 0;
-        }
-    };
-    while (std::getline(f, line)) {
-        std::string t = trim(line);
-        if (t.empty() || t == "[" || t == "]") continue;
-        if (t.find('{') != std::string::npos) {
-            in_object = true;
-            current = Monster();
-            continue;
-        }
-        if (t.find('}') != std::string::npos) {
-            if (in_object) {
-                // push only if id and name have been set
-                if (!current.id.empty() && !current.name.empty()) {
-                    monsters.push_back(current);
-                }
-                in_object = false;
-            }
-            continue;
-        }
-        if (!in_object) continue;
-        if (t.find("\"id\"") != std::string::npos) {
-            current.id = extract_string_value(t);
-        } else if (t.find("\"name\"") != std::string::npos && t.find("\"str\"") != std::string::npos) {
-            current.name = extract_string_value(t);
-        } else if (t.find("\"hp\"") != std::string::npos) {
-            current.hp = extract_int_value(t);
-        } else if (t.find("\"melee_dice_sides\"") != std::string::npos) {
-            current.melee_dice_sides = extract_int_value(t);
-        } else if (t.find("\"melee_dice\"") != std::string::npos) {
-            current.melee_dice = extract_int_value(t);
-        } else if (t.find("\"armor\"") != std::string::npos) {
-            current.armor = extract_int_value(t);
-        }
+    std::unique_ptr<metrics::FileDumper> metrics_dumper;
+    if (!metrics_path.empty()) {
+        metrics_dumper = std::make_unique<metrics::FileDumper>(
+            metrics_path, std::chrono::seconds(metrics_interval));
     }
-    return monsters;
-}
-
-/**
- * Load items from the given JSON file. This function performs a very
- * simplistic parse that extracts the value of the "id" field and
- * the "str" field under the "name" object. Each complete item is
- * appended to the returned vector. If the file cannot be opened,
- * an empty vector is returned and an error is printed to stderr.
- */
-std::vector<Item> load_items(const std::string &filename) {
-    std::vector<Item> items;
-    std::ifstream f(filename);
-    if (!f) {
-        std::cerr << "Failed to open " << filename << std::endl;
-        return items;
+    memory::register_metrics();
+    metrics::Counter &commands_total = metrics::counter("commands_total", "Commands processed.");
+    metrics::Histogram &command_latency = metrics::histogram("command_latency_seconds", "Time to process one command.");
+    std::cout << "Welcome to the Survival Project!" << std::endl;
+    // Content files are independent, so load them in parallel on the
+    // job pool and join before printing.
+    ItemTable item_types;
+    RecipeTable recipes;
+    MonsterTable monsters;
+    {
+        PROFILE_SCOPE("load.all");
+        jobs::Pool &pool = jobs::default_pool();
+        // Items represent the available objects in the world that the
+        // player can pick up; monsters are available to fight.
+        auto items_job = pool.submit([]() { return load_items("data/json/items.json"); });
+        auto recipes_job = pool.submit([]() { return load_recipes("data/json/recipes.json"); });
+        auto monsters_job = pool.submit([]() { return load_monsters("data/json/monsters.json"); });
+        item_types = items_job.get();
+        recipes = recipes_job.get();
+        monsters = monsters_job.get();
     }
-    Item current;
-    std::string line;
-    while (std::getline(f, line)) {
-        // Look for "id": "value"
-        auto id_pos = line.find("\"id\"");
-        if (id_pos != std::string::npos) {
-            auto colon = line.find(':', id_pos);
-            auto q1 = line.find('"', colon + 1);
-            auto q2 = line.find('"', q1 + 1);
-            if (q1 != std::string::npos && q2 != std::string::npos) {
-                current.id = line.substr(q1 + 1, q2 - q1 - 1);
-            }
+    // Groups refer to item and monster definitions, so they load once
+    // those are in.
+    ItemGroupTable item_groups = load_item_groups("data/json/item_groups.json", item_types);
+    MonsterGroupTable monster_groups = load_monster_groups("data/json/monster_groups.json", monsters);
+    // Game time, in turns, and the events scheduled against it. Commands
+    // are instantaneous; only waiting and walking pass time.
+    TimerWheel timers;
+    // Item definitions stay in their table for the whole run; the world
+    // starts out with one instance of each.
+    std::vector<ItemHandle> world_items;
+    {
+        memory::TagScope tag(memory::Tag::world);
+        world_items.reserve(item_types.size());
+        for (const Item &type : item_types) {
+            world_items.push_back(spawn_item(type, timers.now()));
         }
-        // Look for "str": "value" (the item name)
-        auto name_pos = line.find("\"str\"");
-        if (name_pos != std::string::npos) {
-            auto colon = line.find(':', name_pos);
-            auto q1 = line.find('"', colon + 1);
-            auto q2 = line.find('"', q1 + 1);
-            if (q1 != std::string::npos && q2 != std::string::npos) {
-                current.name = line.substr(q1 + 1, q2 - q1 - 1);
-                // When we find a name we assume the item record is complete
-                items.push_back(current);
-                current = Item();
+    }
+    // Print the handles in a list by their item definitions. Freshness
+    // is worked out as the list is printed.
+    auto print_items = [&timers](const std::vector<ItemHandle> &items) {
+        for (ItemHandle h : items) {
+            if (const Item *item = item_type(h)) {
+                std::cout << " - " << item->id << ": " << item->name << freshness_label(h, timers.now()) << std::endl;
             }
         }
-    }
-    return items;
-}
-
-int main() {
-    std::cout << "Welcome to the Survival Project!" << std::endl;
-    // Load items from the default JSON file. These items represent
-    // the available objects in the world that the player can pick up.
-    std::vector<Item> world_items = load_items("data/json/items.json");
+    };
     std::cout << "Loaded " << world_items.size() << " item(s)." << std::endl;
-    for (const auto &item : world_items) {
-        std::cout << " - " << item.id << ": " << item.name << std::endl;
-    }
-    // Load recipes from JSON
-    std::vector<Recipe> recipes = load_recipes("data/json/recipes.json");
-    // Load monsters from JSON. These creatures are available to fight.
-    std::vector<Monster> monsters = load_monsters("data/json/monsters.json");
+    print_items(world_items);
     std::cout << "Loaded " << monsters.size() << " monster(s)." << std::endl;
     for (const auto &m : monsters) {
         std::cout << " - " << m.id << ": " << m.name << " (hp=" << m.hp << ")" << std::endl;
     }
-    // Create the player
+    std::cout << "Loaded " << item_groups.size() << " item group(s) and " << monster_groups.size()
+              << " monster group(s)." << std::endl;
+    // The tile map around the player, filled by the spawn command. Each
+    // spawn draws from its own seed so repeated spawns differ.
+    Map world_map;
+    const uint64_t world_seed = 1;
+    uint64_t spawns = 0;
+    // Create the player, and the craft they are working on, if any
     Player player;
+    CraftProgress craft;
+    // The world at large, generated an overmap at a time as the player
+    // nears it.
+    OvermapBuffer overmaps(static_cast<uint32_t>(world_seed));
+    // Hordes roaming the overmaps, placed by the horde command.
+    Hordes hordes;
+    uint64_t horde_spawns = 0;
+    // Level of detail the active area is simulated at, kept within the
+    // turn budget.
+    LodController lod;
+    // Light over the map, and the lamp the player carries when lit.
+    Lighting lighting;
+    LightId lamp;
+    // Compass directions for walking and building, as tile offsets.
+    static const std::pair<const char *, Point> kDirections[] = {
+        {"n", {0, -1}}, {"s", {0, 1}},   {"e", {1, 0}},   {"w", {-1, 0}},
+        {"ne", {1, -1}}, {"nw", {-1, -1}}, {"se", {1, 1}}, {"sw", {-1, 1}}};
+    auto direction = [](const std::string &name) {
+        for (const auto &[dir, offset] : kDirections) {
+            if (name == dir) return offset;
+        }
+        return Point();
+    };
+    // Pass `turns` turns: fire due events and simulate the active area
+    // around the player. Returns the number of events fired.
+    auto pass_turns = [&](uint64_t turns, TurnStats &sim) {
+        const uint64_t end = timers.now() + turns;
+        const Point center = submap_of(player.pos);
+        bool quiet = area_is_quiet(world_map, center, kActiveRadius);
+        size_t fired = 0;
+        while (timers.now() < end) {
+            // The simulation's scratch data lasts one game turn, or one
+            // quiet stretch of them.
+            frame::begin_turn();
+            // With no monsters or fields about, nothing in the active
+            // area changes from turn to turn, so jump to the next turn
+            // hordes move on; its submaps catch up the next time they
+            // are simulated. A horde arriving ends the quiet.
+            uint64_t t = quiet ? std::min(end, Hordes::next_step(timers.now())) : timers.now() + 1;
+            fired += timers.advance(t, [](TimerId, TimerEvent) {});
+            if (quiet) {
+                if (hordes.update(world_map, center, kActiveRadius, t, world_seed).expanded) quiet = false;
+                continue;
+            }
+            auto started = std::chrono::steady_clock::now();
+            sim += simulate_turn(world_map, center, kActiveRadius, t, world_seed, lod.level());
+            hordes.update(world_map, center, kActiveRadius, t, world_seed);
+            std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - started;
+            lod.record(elapsed.count());
+        }
+        return fired;
+    };
     // Command loop
     std::cout << "\nAvailable commands:\n"
               << " - list items      : list items available in the world\n"
-              << " - inventory       : list items in your inventory\n"
+              << " - inventory [f]   : list items in your inventory, or those of category,\n"
+              << "                     material or flag f sorted by name\n"
               << " - take <id>       : pick up an item from the world\n"
               << " - drop <id>       : drop an item from your inventory\n"
-              << " - craft <recipe>  : craft an item using a recipe\n"
+              << " - craft [recipe]  : craft an item using a recipe, or resume an\n"
+              << "                     interrupted craft\n"
               << " - list monsters   : list monsters in the world\n"
               << " - fight <id>      : fight a monster\n"
+              << " - spawn <group> [r]: scatter items from an item group, or packs from a\n"
+              << "                     monster group, over the submaps within r\n"
+              << "                     (default 1) of yours\n"
+              << " - field <type> [r]: start a fire, or release smoke or toxic_gas, on the\n"
+              << "                     tiles within r (default 0) of yours\n"
+              << " - map             : show items, fields and monsters on the map around you\n"
+              << " - walk <dir> [n]  : walk n tiles (default 1) north, south, east or\n"
+              << "                     west (n, s, e, w, ne, ...), one turn per tile\n"
+              << " - wall <dir>      : build or knock down a wall next to you\n"
+              << " - lamp            : light or put out your lamp\n"
+              << " - light           : show the light around you\n"
+              << " - overmap [r]     : show the overmap tiles within r (default 20) of yours\n"
+              << " - horde [group] [n]: set n hordes (default 200) from a monster group\n"
+              << "                     roaming your overmap, or show the nearest hordes\n"
+              << " - wait [n]        : let n turns (default 1) pass\n"
+              << " - lod [budget <us> | fix <level> | auto]: show turn times and the level\n"
+              << "                     of detail, or set the turn budget or level\n"
+              << " - profile [reset] : show or clear profiler timings\n"
+              << " - trace start     : start recording trace spans\n"
+              << " - trace stop <f>  : stop recording and write Chrome trace JSON\n"
+              << " - metrics         : print runtime metrics\n"
+              << " - memory          : show memory usage by subsystem\n"
               << " - quit            : exit the game\n";
     std::string line;
     while (true) {
@@ -326,124 +246,183 @@ int main() {
         if (start == std::string::npos) {
             continue;
         }
+        PROFILE_SCOPE("loop.command");
+        // Each command starts a frame, and so does each game turn it
+        // passes (see pass_turns); memory from the previous frame is
+        // recycled.
+        frame::begin_turn();
+        metrics::ScopedTimer command_timer(command_latency);
+        commands_total.add();
         std::istringstream iss(line);
         std::string command;
         std::string arg;
         iss >> command;
         std::getline(iss, arg);
         if (!arg.empty() && arg[0] == ' ') arg.erase(0, 1);
+        // Ids given as arguments are hashed once and then matched
+        // against content by hash.
+        Id arg_id(arg);
         if (command == "quit") {
             break;
         } else if (command == "list" && arg == "items") {
+            PROFILE_SCOPE("cmd.list_items");
             if (world_items.empty()) {
                 std::cout << "There are no items in the world." << std::endl;
             } else {
                 std::cout << "World items:" << std::endl;
-                for (const auto &item : world_items) {
-                    std::cout << " - " << item.id << ": " << item.name << std::endl;
+                print_items(world_items);
+            }
+        } else if (command == "inventory" && !arg.empty()) {
+            PROFILE_SCOPE("cmd.inventory_filter");
+            // The first facet that knows the word wins.
+            const Inventory &inv = player.inventory;
+            const char *facet_names[] = {"category", "material", "flag"};
+            bool found = false;
+            for (int f = 0; f < static_cast<int>(Inventory::Facet::count) && !found; ++f) {
+                Span<const Inventory::NodeId> matches = inv.with(static_cast<Inventory::Facet>(f), arg_id);
+                if (matches.empty()) continue;
+                found = true;
+                std::cout << "Inventory items with " << facet_names[f] << " '" << arg << "':" << std::endl;
+                for (Inventory::NodeId n : matches) {
+                    std::cout << " - " << inv.type(n)->id << ": " << inv.type(n)->name
+                              << freshness_label(inv.item(n), timers.now()) << std::endl;
                 }
             }
+            if (!found) {
+                std::cout << "No items in your inventory have category, material or flag '" << arg << "'." << std::endl;
+            }
         } else if (command == "inventory") {
+            PROFILE_SCOPE("cmd.inventory");
             if (player.inventory.empty()) {
                 std::cout << "Your inventory is empty." << std::endl;
             } else {
                 std::cout << "Inventory:" << std::endl;
-                for (const auto &item : player.inventory) {
-                    std::cout << " - " << item.id << ": " << item.name << std::endl;
-                }
+                const Inventory &inv = player.inventory;
+                inv.walk([&](Inventory::NodeId n, int depth) {
+                    const Item *item = item_type(inv.item(n));
+                    if (!item) return;
+                    std::cout << std::string(depth * 2, ' ') << " - " << item->id << ": " << item->name
+                              << freshness_label(inv.item(n), timers.now());
+                    if (!item->pockets.empty()) {
+                        // Containers show what their pockets hold.
+                        int64_t used = 0;
+                        int64_t capacity = 0;
+                        for (Inventory::NodeId p = inv.first_child(n); p != Inventory::kNone; p = inv.next_sibling(p)) {
+                            used += inv.contained_volume(p);
+                            capacity += inv.max_volume(p);
+                        }
+                        std::cout << " (" << inv.count(n) - 1 << " item(s), " << inv.weight(n) / 1000.0 << " kg, "
+                                  << used / 1000.0 << "/" << capacity / 1000.0 << " L)";
+                    }
+                    std::cout << std::endl;
+                });
             }
+            std::cout << "Carrying " << player.carried_weight() / 1000.0 << "/" << Player::kWeightCapacity / 1000.0
+                      << " kg, " << player.carried_volume() / 1000.0 << "/" << Player::kVolumeCapacity / 1000.0
+                      << " L outside containers." << std::endl;
         } else if (command == "take") {
+            PROFILE_SCOPE("cmd.take");
             if (arg.empty()) {
                 std::cout << "Usage: take <item id>" << std::endl;
                 continue;
             }
-            bool found = false;
-            for (auto it = world_items.begin(); it != world_items.end(); ++it) {
-                if (it->id == arg) {
-                    player.add_item(*it);
-                    std::cout << "You pick up the " << it->name << "." << std::endl;
-                    world_items.erase(it);
-                    found = true;
-                    break;
-                }
-            }
+            const ItemHandle *found = find_handle(world_items, arg_id);
             if (!found) {
                 std::cout << "Item '" << arg << "' not found in the world." << std::endl;
+            } else {
+                ItemHandle taken = *found;
+                const Item *type = item_type(taken);
+                if (!player.can_carry(*type)) {
+                    std::cout << "The " << type->name << " is too heavy or bulky to carry." << std::endl;
+                    continue;
+                }
+                world_items.erase(world_items.begin() + (found - world_items.data()));
+                player.add_item(taken);
+                std::cout << "You pick up the " << type->name << "." << std::endl;
             }
         } else if (command == "drop") {
+            PROFILE_SCOPE("cmd.drop");
             if (arg.empty()) {
                 std::cout << "Usage: drop <item id>" << std::endl;
                 continue;
             }
-            Item removed;
-            if (player.remove_item(arg, removed)) {
+            ItemHandle removed;
+            std::vector<ItemHandle> contents;
+            if (player.remove_item(arg_id, removed, &contents)) {
+                // A dropped container takes its contents with it.
+                memory::TagScope tag(memory::Tag::world);
                 world_items.push_back(removed);
-                std::cout << "You drop the " << removed.name << "." << std::endl;
+                world_items.insert(world_items.end(), contents.begin(), contents.end());
+                std::cout << "You drop the " << item_type(removed)->name;
+                if (!contents.empty()) {
+                    std::cout << " and the " << contents.size() << " item(s) inside it";
+                }
+                std::cout << "." << std::endl;
             } else {
                 std::cout << "Item '" << arg << "' not found in your inventory." << std::endl;
             }
         } else if (command == "craft") {
-            if (arg.empty()) {
+            PROFILE_SCOPE("cmd.craft");
+            if (arg.empty() && !craft.active()) {
                 std::cout << "Usage: craft <recipe id>" << std::endl;
                 continue;
             }
-            // Find recipe by id
-            const Recipe *selected = nullptr;
-            for (const auto &rec : recipes) {
-                if (rec.id == arg) {
-                    selected = &rec;
-                    break;
+            if (!arg.empty()) {
+                // Find recipe by id
+                const Recipe *selected = find_recipe(recipes, arg_id);
+                if (!selected) {
+                    std::cout << "Recipe '" << arg << "' not found." << std::endl;
+                    continue;
                 }
-            }
-            if (!selected) {
-                std::cout << "Recipe '" << arg << "' not found." << std::endl;
-                continue;
-            }
-            // Check if player has required components
-            bool can_craft = true;
-            std::vector<Item> removed_items;
-            for (const auto &req : selected->components) {
-                const std::string &comp_id = req.first;
-                int qty_needed = req.second;
-                int qty_found = 0;
-                // Remove items up to qty_needed
-                for (int i = 0; i < qty_needed; ++i) {
-                    Item removed;
-                    if (player.remove_item(comp_id, removed)) {
-                        removed_items.push_back(removed);
-                        qty_found++;
-                    } else {
-                        break;
-                    }
+                if (craft.active() && craft.recipe != selected) {
+                    std::cout << "You are in the middle of crafting '" << craft.recipe->id
+                              << "'. Type 'craft' to resume it." << std::endl;
+                    continue;
                 }
-                if (qty_found < qty_needed) {
-                    can_craft = false;
-                    // Return removed items back to inventory
-                    for (const auto &itm : removed_items) {
-                        player.add_item(itm);
+                if (!craft.active()) {
+                    if (!find_item(item_types, selected->result)) {
+                        std::cout << "Recipe '" << selected->id << "' makes unknown item '" << selected->result << "'." << std::endl;
+                        continue;
                     }
-                    break;
+                    // Check if player has required components
+                    if (!consume_components(player, *selected)) {
+                        std::cout << "You don't have the required components to craft '" << selected->id << "'." << std::endl;
+                        continue;
+                    }
+                    craft = CraftProgress{selected, 0};
                 }
             }
-            if (!can_craft) {
-                std::cout << "You don't have the required components to craft '" << selected->id << "'." << std::endl;
-            } else {
-                // Add result item to inventory. Try to find an existing item definition
-                auto it = std::find_if(world_items.begin(), world_items.end(), [&](const Item &itm) {
-                    return itm.id == selected->result;
-                });
-                Item crafted;
-                if (it != world_items.end()) {
-                    crafted = *it;
-                } else {
-                    // If not found in world_items, create a generic item with id as name
-                    crafted.id = selected->result;
-                    crafted.name = selected->result;
-                }
+            // Work until done or a monster comes close. Turns pass in
+            // batches that no monster can cover before getting within
+            // the interrupt distance, and that end before a horde could
+            // expand into the active area.
+            TurnStats sim;
+            uint64_t worked = work_on(
+                craft,
+                [&]() { return craft_safe_turns(world_map, hordes, player.pos, kActiveRadius, timers.now()); },
+                [&](uint64_t turns) { pass_turns(turns, sim); });
+            if (craft.remaining() > 0) {
+                std::cout << "A monster is too close to keep crafting '" << craft.recipe->id << "'; you stop after "
+                          << worked << " turn(s), with " << craft.remaining()
+                          << " to go. Type 'craft' to resume." << std::endl;
+                continue;
+            }
+            // Add result item to inventory, or set it down if it does
+            // not fit.
+            ItemHandle crafted = make_result(*craft.recipe, item_types, timers.now());
+            uint64_t total = craft.done;
+            craft = CraftProgress();
+            const Item *type = item_type(crafted);
+            if (player.can_carry(*type)) {
                 player.add_item(crafted);
-                std::cout << "You craft a " << crafted.name << "!" << std::endl;
+                std::cout << "You craft a " << type->name << " after " << total << " turn(s) of work!" << std::endl;
+            } else {
+                memory::TagScope tag(memory::Tag::world);
+                world_items.push_back(crafted);
+                std::cout << "You craft a " << type->name << ", but it is too much to carry and you set it down." << std::endl;
             }
         } else if (command == "list" && arg == "monsters") {
+            PROFILE_SCOPE("cmd.list_monsters");
             if (monsters.empty()) {
                 std::cout << "There are no monsters in the world." << std::endl;
             } else {
@@ -453,61 +432,416 @@ int main() {
                 }
             }
         } else if (command == "fight") {
+            PROFILE_SCOPE("cmd.fight");
             if (arg.empty()) {
                 std::cout << "Usage: fight <monster id>" << std::endl;
                 continue;
             }
             // Find monster by id
-            auto it_mon = std::find_if(monsters.begin(), monsters.end(), [&](const Monster &m) {
-                return m.id == arg;
-            });
-            if (it_mon == monsters.end()) {
+            const Monster *target = find_monster(monsters, arg_id);
+            if (!target) {
                 std::cout << "Monster '" << arg << "' not found." << std::endl;
                 continue;
             }
-            Monster enemy = *it_mon;
-            std::cout << "You engage the " << enemy.name << "!" << std::endl;
-            // Simple combat loop
-            while (player.hp > 0 && enemy.hp > 0) {
-                // Player attacks first
-                int damage = 1;
-                std::string weapon_name = "fists";
-                if (!player.inventory.empty()) {
-                    const Item &weapon = player.inventory.front();
-                    // Determine damage by summing simple fields. We don't have bashing/cutting separate,
-                    // so assign a default of 5 per item as an example. In a full game this would come
-                    // from item data. Here we check if the id contains "knife" or other hints.
-                    damage = 5;
-                    weapon_name = weapon.name;
+            // The fight is against a fresh instance; its pool slot is
+            // recycled for the next one.
+            MonsterHandle enemy = spawn_monster(*target);
+            CombatLog log(frame::resource());
+            resolve_combat(player, *monster_pool().get(enemy), &log);
+            monster_pool().destroy(enemy);
+            print_combat_log(std::cout, log);
+            if (player.hp <= 0) {
+                // Game over
+                break;
+            }
+        } else if (command == "spawn") {
+            PROFILE_SCOPE("cmd.spawn");
+            std::istringstream args(arg);
+            // Spawning creates every submap in the square, (2r+1)^2 of them.
+            constexpr int kMaxSpawnRadius = 10;
+            std::string group_id;
+            int radius = 1;
+            args >> group_id;
+            if (group_id.empty() || (!args.eof() && !(args >> radius)) || radius < 0 || radius > kMaxSpawnRadius) {
+                std::cout << "Usage: spawn <group id> [radius in submaps, 0-" << kMaxSpawnRadius << "]" << std::endl;
+                continue;
+            }
+            Point here = submap_of(player.pos);
+            Point first{here.x - radius, here.y - radius};
+            Point last{here.x + radius, here.y + radius};
+            if (const ItemGroup *group = item_groups.find(Id(group_id))) {
+                SpawnStats stats = spawn_item_group(world_map, *group, first, last, 0.1, timers.now(),
+                                                    world_seed + spawns++);
+                std::cout << "Spawned " << stats.items << " item(s) from '" << group->id << "' across "
+                          << stats.submaps << " submap(s)." << std::endl;
+            } else if (const MonsterGroup *group = monster_groups.find(Id(group_id))) {
+                // Only submaps without monsters yet are populated.
+                MonsterSpawnStats stats =
+                    spawn_monster_group(world_map, *group, first, last, MonsterSpawnOptions(), timers.now(),
+                                        world_seed + spawns++);
+                std::cout << "Spawned " << stats.monsters << " monster(s) in " << stats.packs << " pack(s) from '"
+                          << group->id << "' across " << stats.submaps << " new submap(s)." << std::endl;
+            } else {
+                std::cout << "Group '" << group_id << "' not found." << std::endl;
+            }
+        } else if (command == "map") {
+            PROFILE_SCOPE("cmd.map");
+            std::cout << world_map.item_count() << " item(s) and " << world_map.monster_count() << " monster(s) on "
+                      << world_map.size() << " submap(s)." << std::endl;
+            // Item counts per tile of the player's submap, with monsters
+            // and the player drawn over them.
+            Point origin = submap_of(player.pos);
+            std::cout << "You are at (" << player.pos.x << ", " << player.pos.y << "), in submap (" << origin.x
+                      << ", " << origin.y << ")." << std::endl;
+            const Submap *here = world_map.find(origin);
+            if (!here) continue;
+            origin = Point{origin.x * kSubmapSize, origin.y * kSubmapSize};
+            std::vector<std::string> rows(kSubmapSize);
+            for (int y = 0; y < kSubmapSize; ++y) {
+                for (int x = 0; x < kSubmapSize; ++x) {
+                    size_t n = here->items_at(x, y).size();
+                    rows[y] += here->opaque(x, y) ? '#' : n == 0 ? '.' : n < 10 ? static_cast<char>('0' + n) : '+';
                 }
-                enemy.hp -= damage;
-                std::cout << "You hit the " << enemy.name << " with your " << weapon_name
-                          << ", dealing " << damage << " damage. (monster hp=" << (enemy.hp > 0 ? enemy.hp : 0) << ")" << std::endl;
-                if (enemy.hp <= 0) {
-                    std::cout << "You defeated the " << enemy.name << "!" << std::endl;
-                    break;
+            }
+            if (const FieldLayer *fields = here->fields()) {
+                // Fire shows over gas, and gas over smoke.
+                for (uint16_t tile : fields->active()) {
+                    for (FieldType type : {FieldType::smoke, FieldType::toxic_gas, FieldType::fire}) {
+                        if (fields->intensity(tile, type) > 0) {
+                            rows[tile / kSubmapSize][tile % kSubmapSize] = field_info(type).glyph;
+                        }
+                    }
                 }
-                // Monster attacks
-                int monster_damage = enemy.melee_dice * enemy.melee_dice_sides;
-                if (monster_damage <= 0) {
-                    monster_damage = 1;
+            }
+            for (MonsterHandle h : here->monsters()) {
+                if (const MonsterInstance *m = monster_pool().get(h)) {
+                    rows[m->pos.y - origin.y][m->pos.x - origin.x] = 'M';
                 }
-                player.hp -= monster_damage;
-                std::cout << "The " << enemy.name << " hits you, dealing " << monster_damage
-                          << " damage. (your hp=" << (player.hp > 0 ? player.hp : 0) << ")" << std::endl;
-                if (player.hp <= 0) {
-                    std::cout << "You were killed by the " << enemy.name << "..." << std::endl;
-                    break;
+            }
+            rows[player.pos.y - origin.y][player.pos.x - origin.x] = '@';
+            for (const std::string &row : rows) {
+                std::cout << " " << row << std::endl;
+            }
+        } else if (command == "wait") {
+            PROFILE_SCOPE("cmd.wait");
+            // A day at most, so a busy active area cannot hold up the
+            // game for long.
+            constexpr long kMaxWaitTurns = 86400;
+            std::istringstream args(arg);
+            long turns = 1;
+            // Anything left after the number, such as the ".5" of
+            // "wait 2.5", makes the argument invalid.
+            auto whole = [&]() { return (args >> std::ws).eof(); };
+            if ((!whole() && !(args >> turns && whole())) || turns <= 0 || turns > kMaxWaitTurns) {
+                std::cout << "Usage: wait [number of turns, 1-" << kMaxWaitTurns << "]" << std::endl;
+                continue;
+            }
+            TurnStats sim;
+            auto started = std::chrono::steady_clock::now();
+            size_t fired = pass_turns(static_cast<uint64_t>(turns), sim);
+            std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - started;
+            std::cout << "You wait " << turns << " turn(s). It is now turn " << timers.now() << "; " << fired
+                      << " event(s) happened, " << timers.size() << " pending." << std::endl;
+            // Turn cost depends on the active area only, not on the map.
+            std::cout << "Simulated " << sim.submaps / static_cast<size_t>(turns) << " of " << world_map.size()
+                      << " submap(s) and " << sim.field_tiles / static_cast<size_t>(turns)
+                      << " field tile(s) per turn (" << sim.caught_up << " caught up, " << sim.items_removed
+                      << " item(s) rotted away) in " << elapsed.count() / static_cast<double>(turns)
+                      << " us per turn." << std::endl;
+            if (sim.deferred) {
+                std::cout << sim.deferred / static_cast<size_t>(turns)
+                          << " submap(s) per turn left for later at level of detail " << lod.level() << "." << std::endl;
+            }
+        } else if (command == "field") {
+            PROFILE_SCOPE("cmd.field");
+            std::istringstream args(arg);
+            // A wider square would reach past the active area around
+            // the player, where the fields would only decay unseen.
+            constexpr int kMaxFieldRadius = (2 * kActiveRadius + 1) * kSubmapSize / 2;
+            std::string name;
+            int radius = 0;
+            FieldType type;
+            args >> name;
+            if (!parse_field_type(name, type) || (!args.eof() && !(args >> radius)) || radius < 0 ||
+                radius > kMaxFieldRadius) {
+                std::cout << "Usage: field <fire|smoke|toxic_gas> [radius in tiles, 0-" << kMaxFieldRadius << "]"
+                          << std::endl;
+                continue;
+            }
+            for (int y = player.pos.y - radius; y <= player.pos.y + radius; ++y) {
+                for (int x = player.pos.x - radius; x <= player.pos.x + radius; ++x) {
+                    place_field(world_map, Point{x, y}, type, FieldLayer::kMaxIntensity, timers.now(), world_seed);
                 }
             }
-            if (player.hp <= 0) {
-                // Game over
-                break;
+            std::cout << "You put " << field_info(type).name << " on " << (2 * radius + 1) * (2 * radius + 1)
+                      << " tile(s) around you." << std::endl;
+        } else if (command == "walk") {
+            PROFILE_SCOPE("cmd.walk");
+            std::istringstream args(arg);
+            std::string dir;
+            long tiles = 1;
+            args >> dir;
+            Point step = direction(dir);
+            if (step == Point() || (!args.eof() && !(args >> tiles)) || tiles <= 0) {
+                std::cout << "Usage: walk <n|s|e|w|ne|nw|se|sw> [number of tiles]" << std::endl;
+                continue;
+            }
+            TurnStats sim;
+            for (long i = 0; i < tiles; ++i) {
+                player.pos.x += step.x;
+                player.pos.y += step.y;
+                lighting.move(lamp, player.pos);
+                pass_turns(1, sim);
+            }
+            Point sm = submap_of(player.pos);
+            std::cout << "You walk to (" << player.pos.x << ", " << player.pos.y << "), in submap (" << sm.x << ", "
+                      << sm.y << "). It is now turn " << timers.now() << "." << std::endl;
+            if (sim.caught_up) {
+                std::cout << sim.caught_up << " submap(s) came back into view and were caught up." << std::endl;
+            }
+        } else if (command == "wall") {
+            PROFILE_SCOPE("cmd.wall");
+            Point step = direction(arg);
+            if (step == Point()) {
+                std::cout << "Usage: wall <n|s|e|w|ne|nw|se|sw>" << std::endl;
+                continue;
+            }
+            Point tile{player.pos.x + step.x, player.pos.y + step.y};
+            Submap &sm = world_map.submap(submap_of(tile));
+            int x = tile.x - sm.pos().x * kSubmapSize;
+            int y = tile.y - sm.pos().y * kSubmapSize;
+            bool build = !sm.opaque(x, y);
+            sm.set_opaque(x, y, build);
+            lighting.terrain_changed(tile);
+            std::cout << (build ? "You build a wall." : "You knock the wall down.") << std::endl;
+        } else if (command == "lamp") {
+            if (lighting.remove(lamp)) {
+                std::cout << "You put out your lamp." << std::endl;
+            } else {
+                lamp = lighting.add(LightSource{player.pos, 8, 200});
+                std::cout << "You light your lamp." << std::endl;
+            }
+        } else if (command == "light") {
+            PROFILE_SCOPE("cmd.light");
+            // Bring the light up to date, then show the player's
+            // submap: light levels from 1 to 9, blank where dark.
+            size_t recomputed = lighting.update(world_map);
+            std::cout << lighting.size() << " light source(s), " << recomputed << " recomputed." << std::endl;
+            Point sm = submap_of(player.pos);
+            const Submap *here = world_map.find(sm);
+            Point origin{sm.x * kSubmapSize, sm.y * kSubmapSize};
+            for (int y = 0; y < kSubmapSize; ++y) {
+                std::string row;
+                for (int x = 0; x < kSubmapSize; ++x) {
+                    int level = lighting.at(Point{origin.x + x, origin.y + y});
+                    if (origin.x + x == player.pos.x && origin.y + y == player.pos.y) {
+                        row += '@';
+                    } else if (here && here->opaque(x, y)) {
+                        row += '#';
+                    } else {
+                        row += level == 0 ? ' ' : static_cast<char>('0' + (level * 9 + 254) / 255);
+                    }
+                }
+                std::cout << " " << row << std::endl;
+            }
+        } else if (command == "overmap") {
+            PROFILE_SCOPE("cmd.overmap");
+            // At most an overmap's width is drawn, so a few overmaps are
+            // generated at most.
+            constexpr long kMaxOvermapRadius = kOvermapSize / 2;
+            long radius = arg.empty() ? 20 : std::strtol(arg.c_str(), nullptr, 10);
+            if (radius <= 0 || radius > kMaxOvermapRadius) {
+                std::cout << "Usage: overmap [radius in overmap tiles, 1-" << kMaxOvermapRadius << "]" << std::endl;
+                continue;
+            }
+            Point omt = omt_of(submap_of(player.pos));
+            auto started = std::chrono::steady_clock::now();
+            const Overmap &here = overmaps.get(overmap_of(omt));
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - started;
+            std::cout << "Overmap (" << here.pos().x << ", " << here.pos().y << "): ";
+            for (int t = 0; t < kOvermapTerrains; ++t) {
+                OvermapTerrain terrain = static_cast<OvermapTerrain>(t);
+                std::cout << (t ? ", " : "") << here.count(terrain) << " " << terrain_name(terrain);
+            }
+            std::cout << " tile(s); " << overmaps.size() << " overmap(s) generated with "
+                      << simd_path_name(best_simd_path()) << " noise, this lookup took " << elapsed.count() << " ms."
+                      << std::endl;
+            // Terrain around the player, with hordes on the overmap
+            // drawn over it.
+            std::vector<std::string> rows;
+            for (long y = omt.y - radius; y <= omt.y + radius; ++y) {
+                std::string row;
+                for (long x = omt.x - radius; x <= omt.x + radius; ++x) {
+                    Point at{static_cast<int>(x), static_cast<int>(y)};
+                    row += at == omt ? '@' : terrain_glyph(overmaps.terrain(at));
+                }
+                rows.push_back(std::move(row));
+            }
+            for (const Horde &horde : hordes.hordes()) {
+                if (horde.expanded) continue;
+                long x = horde.omt.x - (omt.x - radius);
+                long y = horde.omt.y - (omt.y - radius);
+                if (x >= 0 && y >= 0 && x <= 2 * radius && y <= 2 * radius && rows[y][x] != '@') rows[y][x] = 'H';
+            }
+            for (const std::string &row : rows) {
+                std::cout << " " << row << std::endl;
+            }
+        } else if (command == "horde") {
+            PROFILE_SCOPE("cmd.horde");
+            // Hordes are made in one go; more than this would hold up
+            // the game for seconds.
+            constexpr long kMaxHordes = 100000;
+            std::istringstream args(arg);
+            std::string group_id;
+            long count = 200;
+            args >> group_id;
+            // Anything left after the count makes it invalid.
+            auto whole = [&]() { return (args >> std::ws).eof(); };
+            const Point center = submap_of(player.pos);
+            const Point omt = omt_of(center);
+            if (!group_id.empty()) {
+                const MonsterGroup *group = monster_groups.find(Id(group_id));
+                if (!group || (!whole() && !(args >> count && whole())) || count <= 0 || count > kMaxHordes) {
+                    std::cout << "Usage: horde [monster group id] [number of hordes, 1-" << kMaxHordes << "]"
+                              << std::endl;
+                    continue;
+                }
+                const Overmap &overmap = overmaps.get(overmap_of(omt));
+                size_t added = hordes.populate(overmap, *group, static_cast<size_t>(count), 20, 80,
+                                               world_seed + horde_spawns++);
+                HordeStats stats = hordes.update(world_map, center, kActiveRadius, timers.now(), world_seed);
+                std::cout << "Set " << count << " horde(s) of " << added << " monster(s) from '" << group->id
+                          << "' roaming overmap (" << overmap.pos().x << ", " << overmap.pos().y << "); "
+                          << stats.expanded << " expanded around you." << std::endl;
+            }
+            // Hordes by distance in overmap tiles, nearest first.
+            std::vector<std::pair<int, const Horde *>> nearest;
+            size_t expanded = 0;
+            for (const Horde &horde : hordes.hordes()) {
+                expanded += horde.expanded;
+                int d = std::max(std::abs(horde.omt.x - omt.x), std::abs(horde.omt.y - omt.y));
+                nearest.emplace_back(horde.expanded ? 0 : d, &horde);
+            }
+            size_t shown = std::min<size_t>(nearest.size(), 5);
+            std::partial_sort(nearest.begin(), nearest.begin() + shown, nearest.end(),
+                              [](const auto &a, const auto &b) { return a.first < b.first; });
+            std::cout << hordes.size() << " horde(s) of " << hordes.monster_count() << " monster(s), " << expanded
+                      << " expanded on the map." << std::endl;
+            for (size_t i = 0; i < shown; ++i) {
+                const Horde &horde = *nearest[i].second;
+                std::cout << " - " << horde.size() << " monster(s) ";
+                if (horde.expanded) {
+                    std::cout << "around you" << std::endl;
+                } else {
+                    std::cout << nearest[i].first << " overmap tile(s) away at (" << horde.omt.x << ", "
+                              << horde.omt.y << "), heading for (" << horde.destination.x << ", "
+                              << horde.destination.y << ")" << std::endl;
+                }
+            }
+        } else if (command == "lod") {
+            std::istringstream args(arg);
+            std::string action;
+            double budget = 0;
+            int level = 0;
+            args >> action;
+            // Anything left after the number, such as the ".5" of
+            // "fix 2.5", makes the argument invalid.
+            auto whole = [&]() { return (args >> std::ws).eof(); };
+            if (action == "budget" && args >> budget && whole() && budget > 0) {
+                lod.set_budget_us(budget);
+            } else if (action == "fix" && args >> level && whole() && level >= 0 && level <= kMaxLod) {
+                lod.fix(level);
+            } else if (action == "auto") {
+                lod.fix(-1);
+            } else if (!action.empty()) {
+                std::cout << "Usage: lod [budget <microseconds> | fix <0-" << kMaxLod << "> | auto]" << std::endl;
+                continue;
+            }
+            std::cout << "Level of detail " << lod.level() << (lod.fixed() ? " (fixed)" : " (automatic)")
+                      << ", turn budget " << lod.budget_us() << " us. Last turn took " << lod.last_us()
+                      << " us, " << lod.average_us() << " us on average." << std::endl;
+            std::cout << "Submaps within " << kActiveRadius << " of yours are updated every:";
+            for (int ring = 0; ring <= kActiveRadius; ++ring) {
+                std::cout << (ring ? ", " : " ") << lod_interval(ring, kActiveRadius, lod.level()) << " turn(s) at "
+                          << ring;
+            }
+            std::cout << "." << std::endl << "Turns simulated at each level:";
+            for (int level = 0; level <= kMaxLod; ++level) {
+                std::cout << " " << level << ": " << lod.turns_at(level) << (level < kMaxLod ? "," : ".");
+            }
+            std::cout << std::endl;
+        } else if (command == "profile") {
+            if (arg == "reset") {
+                profiler::reset();
+                std::cout << "Profiler samples cleared." << std::endl;
+            } else {
+                profiler::write_report(std::cout);
+            }
+        } else if (command == "memory") {
+            memory::write_report(std::cout);
+            auto print_footprint = [](const char *label, size_t count, const Footprint &fp) {
+                std::cout << " - " << label << ": " << count << " entries, " << fp.total() << " bytes ("
+                          << fp.object_bytes << " objects, " << fp.string_bytes << " strings)" << std::endl;
+            };
+            std::cout << "Container footprints:" << std::endl;
+            print_footprint("item types", item_types.size(), footprint(item_types));
+            print_footprint("world items", world_items.size(), footprint(world_items));
+            print_footprint("recipes", recipes.size(), footprint(recipes));
+            print_footprint("monsters", monsters.size(), footprint(monsters));
+            print_footprint("item groups", item_groups.size(), footprint(item_groups));
+            print_footprint("monster groups", monster_groups.size(), footprint(monster_groups));
+            print_footprint("map", world_map.item_count(), footprint(world_map));
+            print_footprint("timers", timers.size(), Footprint{timers.bytes_reserved(), 0});
+            print_footprint("lighting", lighting.size(), Footprint{lighting.bytes_reserved(), 0});
+            print_footprint("overmaps", overmaps.size(), Footprint{overmaps.bytes_reserved(), 0});
+            print_footprint("hordes", hordes.size(), Footprint{hordes.bytes_reserved(), 0});
+            print_footprint("inventory", player.inventory.size(), footprint(player.inventory));
+            print_footprint("item pool", item_pool().size(), footprint(item_pool()));
+            print_footprint("monster pool", monster_pool().size(), footprint(monster_pool()));
+            frame::TurnStats last = frame::last_turn();
+            std::cout << "Turn " << last.turn << ": " << last.heap_allocations << " heap allocation(s), "
+                      << last.frame_allocations << " frame allocation(s) (" << last.frame_bytes
+                      << " bytes, " << frame::arena().bytes_reserved() << " bytes reserved)." << std::endl;
+        } else if (command == "metrics") {
+            metrics::write_prometheus(std::cout);
+        } else if (command == "trace") {
+            if (arg == "start") {
+                trace::start();
+                std::cout << "Tracing started." << std::endl;
+            } else if (arg == "stop" || arg.rfind("stop ", 0) == 0) {
+                std::string path = arg.size() > 5 ? arg.substr(5) : "trace.json";
+                trace::stop();
+                if (trace::write_chrome_json_file(path)) {
+                    std::cout << "Trace written to " << path << "." << std::endl;
+                } else {
+                    std::cout << "Failed to write trace to " << path << "." << std::endl;
+                }
+            } else {
+                std::cout << "Usage: trace start | trace stop [file]" << std::endl;
             }
         } else {
-            std::cout << "Unknown command. Type 'list items', 'list monsters', 'inventory', 'take <id>', 'drop <id>', 'craft <recipe>', 'fight <id>' or 'quit'." << std::endl;
+            std::cout << "Unknown command. Type 'list items', 'list monsters', 'inventory [filter]', 'take <id>', 'drop <id>', 'craft [recipe]', 'fight <id>', 'spawn <group>', 'field <type> [r]', 'map', 'walk <dir> [n]', 'wall <dir>', 'lamp', 'light', 'overmap [r]', 'horde [group] [n]', 'wait [n]', 'lod', 'profile', 'trace', 'metrics', 'memory' or 'quit'." << std::endl;
         }
     }
     std::cout << "Goodbye!" << std::endl;
+    if (!trace_path.empty()) {
+        trace::stop();
+        if (!trace::write_chrome_json_file(trace_path)) {
+            std::cerr << "Failed to write trace to " << trace_path << std::endl;
+        }
+    }
+    if (profile_report) {
+        if (profile_report_path.empty()) {
+            std::cout << "\nProfile report:" << std::endl;
+            profiler::write_report(std::cout);
+        } else {
+            std::ofstream out(profile_report_path);
+            if (!out) {
+                std::cerr << "Failed to open " << profile_report_path << std::endl;
+                return 1;
+            }
+            profiler::write_report(out);
+        }
+    }
     return 0;
 }
\ No newline at end of file
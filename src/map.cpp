@@ -0,0 +1,95 @@
+/*
+ * Implementation of the tile map declared in map.h.
+ */
+
+#include "map.h"
+
+#include <algorithm>
+
+#include "memory_tracker.h"
+
+void Submap::add_item(int x, int y, ItemHandle item) {
+    memory::TagScope tag(memory::Tag::world);
+    int t = y * kSubmapSize + x;
+    items_.insert(items_.begin() + item_start_[t + 1], item);
+    for (int i = t + 1; i <= kSubmapTiles; ++i) ++item_start_[i];
+}
+
+void Submap::add_items(Span<const TileItem> batch) {
+    if (batch.empty()) return;
+    memory::TagScope tag(memory::Tag::world);
+    // Counting sort of the old and new items into a fresh vector: count
+    // per tile, turn counts into start offsets, then scatter.
+    std::array<uint32_t, kSubmapTiles + 1> start{};
+    for (int t = 0; t < kSubmapTiles; ++t) start[t + 1] = item_start_[t + 1] - item_start_[t];
+    for (const TileItem &ti : batch) ++start[ti.tile + 1];
+    for (int t = 0; t < kSubmapTiles; ++t) start[t + 1] += start[t];
+    std::vector<ItemHandle> merged(items_.size() + batch.size());
+    std::array<uint32_t, kSubmapTiles> cursor;
+    for (int t = 0; t < kSubmapTiles; ++t) {
+        uint32_t n = item_start_[t + 1] - item_start_[t];
+        std::copy(items_.begin() + item_start_[t], items_.begin() + item_start_[t + 1], merged.begin() + start[t]);
+        cursor[t] = start[t] + n;
+    }
+    for (const TileItem &ti : batch) merged[cursor[ti.tile]++] = ti.item;
+    items_ = std::move(merged);
+    item_start_ = start;
+}
+
+void Submap::add_monster(MonsterHandle monster) {
+    memory::TagScope tag(memory::Tag::world);
+    monsters_.push_back(monster);
+}
+
+bool Submap::remove_monster(MonsterHandle monster) {
+    auto it = std::find(monsters_.begin(), monsters_.end(), monster);
+    if (it == monsters_.end()) return false;
+    *it = monsters_.back();
+    monsters_.pop_back();
+    return true;
+}
+
+FieldLayer &Submap::field_layer() {
+    if (!fields_) {
+        memory::TagScope tag(memory::Tag::world);
+        fields_ = std::make_unique<FieldLayer>();
+    }
+    return *fields_;
+}
+
+Submap *Map::find(Point pos) {
+    auto it = submaps_.find(key(pos));
+    return it != submaps_.end() ? it->second.get() : nullptr;
+}
+
+const Submap *Map::find(Point pos) const {
+    auto it = submaps_.find(key(pos));
+    return it != submaps_.end() ? it->second.get() : nullptr;
+}
+
+Submap &Map::submap(Point pos) {
+    memory::TagScope tag(memory::Tag::world);
+    std::unique_ptr<Submap> &slot = submaps_[key(pos)];
+    if (!slot) {
+        slot = std::make_unique<Submap>(pos);
+    }
+    return *slot;
+}
+
+size_t Map::item_count() const {
+    size_t n = 0;
+    for (const auto &entry : submaps_) n += entry.second->item_count();
+    return n;
+}
+
+size_t Map::monster_count() const {
+    size_t n = 0;
+    for (const auto &entry : submaps_) n += entry.second->monsters().size();
+    return n;
+}
+
+size_t Map::bytes_reserved() const {
+    size_t bytes = submaps_.bucket_count() * sizeof(void *);
+    for (const auto &entry : submaps_) bytes += sizeof(entry) + entry.second->bytes_reserved();
+    return bytes;
+}
@@ -0,0 +1,286 @@
+/*
+ * Implementation of the allocation tracker declared in memory_tracker.h.
+ */
+
+#include "memory_tracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <new>
+#include <string>
+
+#include "metrics.h"
+
+namespace memory {
+
+namespace {
+
+struct alignas(64) Counters {
+    std::atomic<uint64_t> allocations;
+    std::atomic<uint64_t> frees;
+    std::atomic<uint64_t> live_bytes;
+    std::atomic<uint64_t> peak_bytes;
+};
+
+// Zero-initialized before any dynamic initialization, so allocations
+// made during static construction are counted correctly.
+Counters g_counters[static_cast<size_t>(Tag::count)];
+thread_local Tag t_current_tag = Tag::other;
+
+} // namespace
+
+const char *tag_name(Tag tag) {
+    switch (tag) {
+    case Tag::other:
+        return "other";
+    case Tag::content:
+        return "content";
+    case Tag::world:
+        return "world";
+    case Tag::inventory:
+        return "inventory";
+    case Tag::diagnostics:
+        return "diagnostics";
+    case Tag::frame:
+        return "frame";
+    case Tag::count:
+        break;
+    }
+    return "unknown";
+}
+
+bool tracking_enabled() {
+#ifdef SURVIVAL_MEMORY_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+TagStats stats(Tag tag) {
+    const Counters &c = g_counters[static_cast<size_t>(tag)];
+    TagStats s;
+    s.allocations = c.allocations.load(std::memory_order_relaxed);
+    s.frees = c.frees.load(std::memory_order_relaxed);
+    s.live_bytes = c.live_bytes.load(std::memory_order_relaxed);
+    s.peak_bytes = c.peak_bytes.load(std::memory_order_relaxed);
+    return s;
+}
+
+Tag current_tag() {
+    return t_current_tag;
+}
+
+TagScope::TagScope(Tag tag) : previous_(t_current_tag) {
+    t_current_tag = tag;
+}
+
+TagScope::~TagScope() {
+    t_current_tag = previous_;
+}
+
+ProcessMemory process_memory() {
+    ProcessMemory pm;
+    std::ifstream status("/proc/self/status");
+    std::string key;
+    while (status >> key) {
+        uint64_t kib = 0;
+        if (key == "VmRSS:" && status >> kib) {
+            pm.rss_bytes = kib * 1024;
+        } else if (key == "VmHWM:" && status >> kib) {
+            pm.peak_rss_bytes = kib * 1024;
+        }
+        status.ignore(256, '\n');
+    }
+    return pm;
+}
+
+void write_report(std::ostream &out) {
+    auto flags = out.flags();
+    if (!tracking_enabled()) {
+        out << "Allocation tracking is disabled in this build." << std::endl;
+    } else {
+        out << std::left << std::setw(14) << "subsystem" << std::right
+            << std::setw(12) << "allocs"
+            << std::setw(12) << "frees"
+            << std::setw(14) << "live KiB"
+            << std::setw(14) << "peak KiB" << std::endl;
+        out << std::fixed << std::setprecision(1);
+        for (size_t i = 0; i < static_cast<size_t>(Tag::count); ++i) {
+            TagStats s = stats(static_cast<Tag>(i));
+            out << std::left << std::setw(14) << tag_name(static_cast<Tag>(i)) << std::right
+                << std::setw(12) << s.allocations
+                << std::setw(12) << s.frees
+                << std::setw(14) << s.live_bytes / 1024.0
+                << std::setw(14) << s.peak_bytes / 1024.0 << std::endl;
+        }
+    }
+    ProcessMemory pm = process_memory();
+    if (pm.rss_bytes > 0) {
+        out << std::fixed << std::setprecision(1)
+            << "Process RSS: " << pm.rss_bytes / (1024.0 * 1024.0) << " MiB (peak "
+            << pm.peak_rss_bytes / (1024.0 * 1024.0) << " MiB)" << std::endl;
+    }
+    out.flags(flags);
+}
+
+void register_metrics() {
+    static bool registered = false;
+    if (registered) {
+        return;
+    }
+    registered = true;
+    metrics::add_collector([]() {
+        for (size_t i = 0; i < static_cast<size_t>(Tag::count); ++i) {
+            Tag tag = static_cast<Tag>(i);
+            std::string suffix = std::string("_") + tag_name(tag);
+            TagStats s = stats(tag);
+            metrics::gauge("memory_allocations" + suffix, "Allocations made by the subsystem.")
+                .set(static_cast<int64_t>(s.allocations));
+            metrics::gauge("memory_live_bytes" + suffix, "Bytes currently allocated by the subsystem.")
+                .set(static_cast<int64_t>(s.live_bytes));
+            metrics::gauge("memory_peak_bytes" + suffix, "Peak bytes allocated by the subsystem.")
+                .set(static_cast<int64_t>(s.peak_bytes));
+        }
+        ProcessMemory pm = process_memory();
+        metrics::gauge("process_resident_bytes", "Resident set size of the process.")
+            .set(static_cast<int64_t>(pm.rss_bytes));
+    });
+}
+
+} // namespace memory
+
+#ifdef SURVIVAL_MEMORY_TRACKING
+
+namespace {
+
+// Every tracked block starts with this header; the pointer handed out
+// is `offset` bytes past the start of the underlying malloc block.
+struct alignas(16) Header {
+    uint64_t size;
+    uint32_t offset;
+    uint8_t tag;
+};
+static_assert(sizeof(Header) == 16, "header must preserve 16-byte alignment");
+
+void *tracked_alloc(std::size_t size, std::size_t alignment, bool nothrow) {
+    if (alignment < alignof(Header)) {
+        alignment = alignof(Header);
+    }
+    std::size_t padding = alignment > alignof(Header) ? alignment : 0;
+    if (padding > SIZE_MAX - sizeof(Header) || size > SIZE_MAX - sizeof(Header) - padding) {
+        // The request plus its header would wrap around.
+        if (nothrow) {
+            return nullptr;
+        }
+        throw std::bad_alloc();
+    }
+    void *raw = nullptr;
+    while (true) {
+        raw = std::malloc(size + sizeof(Header) + padding);
+        if (raw) {
+            break;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            if (nothrow) {
+                return nullptr;
+            }
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+    uintptr_t base = reinterpret_cast<uintptr_t>(raw) + sizeof(Header);
+    uintptr_t user = (base + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+    Header *h = reinterpret_cast<Header *>(user) - 1;
+    h->size = size;
+    h->offset = static_cast<uint32_t>(user - reinterpret_cast<uintptr_t>(raw));
+    h->tag = static_cast<uint8_t>(memory::t_current_tag);
+
+    memory::Counters &c = memory::g_counters[h->tag];
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    uint64_t live = c.live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+    uint64_t peak = c.peak_bytes.load(std::memory_order_relaxed);
+    while (live > peak && !c.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    return reinterpret_cast<void *>(user);
+}
+
+void tracked_free(void *ptr) noexcept {
+    if (!ptr) {
+        return;
+    }
+    Header *h = static_cast<Header *>(ptr) - 1;
+    memory::Counters &c = memory::g_counters[h->tag];
+    c.frees.fetch_add(1, std::memory_order_relaxed);
+    c.live_bytes.fetch_sub(h->size, std::memory_order_relaxed);
+    std::free(static_cast<char *>(ptr) - h->offset);
+}
+
+} // namespace
+
+void *operator new(std::size_t size) {
+    return tracked_alloc(size, 0, false);
+}
+void *operator new[](std::size_t size) {
+    return tracked_alloc(size, 0, false);
+}
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    return tracked_alloc(size, 0, true);
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return tracked_alloc(size, 0, true);
+}
+void *operator new(std::size_t size, std::align_val_t align) {
+    return tracked_alloc(size, static_cast<std::size_t>(align), false);
+}
+void *operator new[](std::size_t size, std::align_val_t align) {
+    return tracked_alloc(size, static_cast<std::size_t>(align), false);
+}
+void *operator new(std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept {
+    return tracked_alloc(size, static_cast<std::size_t>(align), true);
+}
+void *operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept {
+    return tracked_alloc(size, static_cast<std::size_t>(align), true);
+}
+
+void operator delete(void *ptr) noexcept {
+    tracked_free(ptr);
+}
+void operator delete[](void *ptr) noexcept {
+    tracked_free(ptr);
+}
+void operator delete(void *ptr, std::size_t) noexcept {
+    tracked_free(ptr);
+}
+void operator delete[](void *ptr, std::size_t) noexcept {
+    tracked_free(ptr);
+}
+void operator delete(void *ptr, const std::nothrow_t &) noexcept {
+    tracked_free(ptr);
+}
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept {
+    tracked_free(ptr);
+}
+void operator delete(void *ptr, std::align_val_t) noexcept {
+    tracked_free(ptr);
+}
+void operator delete[](void *ptr, std::align_val_t) noexcept {
+    tracked_free(ptr);
+}
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept {
+    tracked_free(ptr);
+}
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept {
+    tracked_free(ptr);
+}
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+    tracked_free(ptr);
+}
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+    tracked_free(ptr);
+}
+
+#endif // SURVIVAL_MEMORY_TRACKING
@@ -0,0 +1,250 @@
+/*
+ * Implementation of the metrics registry declared in metrics.h.
+ */
+
+#include "metrics.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "memory_tracker.h"
+
+namespace metrics {
+
+namespace detail {
+
+size_t thread_shard() {
+    static std::atomic<size_t> next{0};
+    thread_local size_t shard = next.fetch_add(1, std::memory_order_relaxed) % kShards;
+    return shard;
+}
+
+} // namespace detail
+
+namespace {
+
+unsigned highest_bit(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63u - static_cast<unsigned>(__builtin_clzll(v));
+#else
+    unsigned bit = 0;
+    while (v >>= 1) {
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+enum class Kind { counter, gauge, histogram };
+
+struct Entry {
+    Kind kind;
+    std::string help;
+    bool nanoseconds = false;
+    std::unique_ptr<Counter> counter;
+    std::unique_ptr<Gauge> gauge;
+    std::unique_ptr<Histogram> histogram;
+};
+
+struct Registry {
+    std::mutex mutex;
+    // Ordered so that exports are stable between dumps.
+    std::map<std::string, Entry> entries;
+    std::mutex collectors_mutex;
+    std::vector<std::function<void()>> collectors;
+};
+
+Registry &registry() {
+    static Registry instance;
+    return instance;
+}
+
+Entry &find_or_create(const std::string &name, const std::string &help, Kind kind) {
+    Registry &reg = registry();
+    memory::TagScope tag(memory::Tag::diagnostics);
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    auto it = reg.entries.find(name);
+    if (it == reg.entries.end()) {
+        Entry entry;
+        entry.kind = kind;
+        entry.help = help;
+        switch (kind) {
+        case Kind::counter:
+            entry.counter = std::make_unique<Counter>();
+            break;
+        case Kind::gauge:
+            entry.gauge = std::make_unique<Gauge>();
+            break;
+        case Kind::histogram:
+            entry.histogram = std::make_unique<Histogram>();
+            break;
+        }
+        it = reg.entries.emplace(name, std::move(entry)).first;
+    }
+    return it->second;
+}
+
+} // namespace
+
+uint64_t Counter::value() const {
+    uint64_t total = 0;
+    for (const Shard &s : shards_) {
+        total += s.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+unsigned Histogram::bucket_index(uint64_t value) {
+    if (value < kSubBuckets) {
+        return static_cast<unsigned>(value);
+    }
+    unsigned shift = highest_bit(value) - kSubBits;
+    unsigned sub = static_cast<unsigned>(value >> shift) - kSubBuckets;
+    return (shift + 1) * kSubBuckets + sub;
+}
+
+uint64_t Histogram::bucket_upper_bound(unsigned index) {
+    if (index < kSubBuckets) {
+        return index;
+    }
+    unsigned shift = index / kSubBuckets - 1;
+    uint64_t sub = index % kSubBuckets;
+    uint64_t lower = (kSubBuckets + sub) << shift;
+    return lower + ((uint64_t{1} << shift) - 1);
+}
+
+void Histogram::record(uint64_t value) {
+    buckets_[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    uint64_t prev = max_.load(std::memory_order_relaxed);
+    while (value > prev && !max_.compare_exchange_weak(prev, value, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t Histogram::quantile(double q) const {
+    uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < kBuckets; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            // The top bucket may be wider than the largest sample.
+            return std::min(bucket_upper_bound(i), max());
+        }
+    }
+    return max();
+}
+
+Counter &counter(const std::string &name, const std::string &help) {
+    return *find_or_create(name, help, Kind::counter).counter;
+}
+
+Gauge &gauge(const std::string &name, const std::string &help) {
+    return *find_or_create(name, help, Kind::gauge).gauge;
+}
+
+Histogram &histogram(const std::string &name, const std::string &help, bool nanoseconds) {
+    Entry &entry = find_or_create(name, help, Kind::histogram);
+    entry.nanoseconds = nanoseconds;
+    return *entry.histogram;
+}
+
+void add_collector(std::function<void()> collector) {
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.collectors_mutex);
+    reg.collectors.push_back(std::move(collector));
+}
+
+void write_prometheus(std::ostream &out) {
+    static const double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+    Registry &reg = registry();
+    {
+        // Collectors register gauges, so run them before taking the
+        // registry lock.
+        std::lock_guard<std::mutex> lock(reg.collectors_mutex);
+        for (const auto &collector : reg.collectors) {
+            collector();
+        }
+    }
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    auto flags = out.flags();
+    auto precision = out.precision();
+    out << std::setprecision(9);
+    for (const auto &kv : reg.entries) {
+        const std::string &name = kv.first;
+        const Entry &e = kv.second;
+        out << "# HELP " << name << ' ' << e.help << '\n';
+        switch (e.kind) {
+        case Kind::counter:
+            out << "# TYPE " << name << " counter\n"
+                << name << ' ' << e.counter->value() << '\n';
+            break;
+        case Kind::gauge:
+            out << "# TYPE " << name << " gauge\n"
+                << name << ' ' << e.gauge->value() << '\n';
+            break;
+        case Kind::histogram: {
+            // Exported as a summary: percentiles are what we read most.
+            double scale = e.nanoseconds ? 1e-9 : 1.0;
+            const Histogram &h = *e.histogram;
+            out << "# TYPE " << name << " summary\n";
+            for (double q : kQuantiles) {
+                out << name << "{quantile=\"" << q << "\"} " << h.quantile(q) * scale << '\n';
+            }
+            out << name << "_sum " << h.sum() * scale << '\n'
+                << name << "_count " << h.count() << '\n';
+            break;
+        }
+        }
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+bool write_prometheus_file(const std::string &path) {
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp);
+        if (!out) {
+            return false;
+        }
+        write_prometheus(out);
+        if (!out) {
+            return false;
+        }
+    }
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+FileDumper::FileDumper(std::string path, std::chrono::milliseconds interval)
+    : path_(std::move(path)), interval_(interval), thread_([this]() { run(); }) {}
+
+FileDumper::~FileDumper() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+    write_prometheus_file(path_);
+}
+
+void FileDumper::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!cv_.wait_for(lock, interval_, [this]() { return stopping_; })) {
+        lock.unlock();
+        write_prometheus_file(path_);
+        lock.lock();
+    }
+}
+
+} // namespace metrics
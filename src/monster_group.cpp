@@ -0,0 +1,227 @@
+/*
+ * Monster group loading and pack spawning for monster_group.h.
+ */
+
+#include "monster_group.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "memory_tracker.h"
+#include "metrics.h"
+#include "profiler.h"
+
+namespace {
+
+struct RawEntry {
+    Id monster;
+    double weight = 100;
+    PackSize pack;
+};
+
+// Keeps monster streams apart from item streams drawn with the same seed.
+constexpr uint64_t kMonsterStream = 0x6d6f6e7374657273ULL;
+
+} // namespace
+
+MonsterGroupTable load_monster_groups(const std::string &filename, const MonsterTable &monsters) {
+    PROFILE_SCOPE("load.monster_groups");
+    memory::TagScope tag(memory::Tag::content);
+    MonsterGroupTable table;
+    std::ifstream f(filename);
+    if (!f) {
+        std::cerr << "Failed to open " << filename << std::endl;
+        return table;
+    }
+    std::vector<MonsterGroup> groups;
+    std::vector<RawEntry> entries;
+    Id current;
+    std::vector<const Monster *> types;
+    std::vector<PackSize> packs;
+    std::vector<double> weights;
+    std::vector<AliasColumn> columns;
+    auto finish_group = [&]() {
+        types.clear();
+        packs.clear();
+        weights.clear();
+        for (const RawEntry &e : entries) {
+            const Monster *monster = find_monster(monsters, e.monster);
+            if (!monster) {
+                std::cerr << "Monster group '" << current << "' references unknown monster '" << e.monster << "'."
+                          << std::endl;
+                continue;
+            }
+            if (!(e.weight > 0)) continue;
+            types.push_back(monster);
+            packs.push_back(e.pack);
+            weights.push_back(e.weight);
+        }
+        if (types.empty()) {
+            std::cerr << "Monster group '" << current << "' has no valid entries." << std::endl;
+            return;
+        }
+        double total = 0;
+        for (double w : weights) total += w;
+        for (double &w : weights) w /= total;
+        build_alias_table(weights, columns);
+        MonsterGroup group;
+        group.id = current;
+        group.monsters = table.arena().copy_array(types.data(), types.size());
+        group.packs = table.arena().copy_array(packs.data(), packs.size());
+        group.probabilities = table.arena().copy_array(weights.data(), weights.size());
+        group.table = AliasTable(table.arena().copy_array(columns.data(), columns.size()));
+        groups.push_back(group);
+    };
+    std::string line;
+    while (std::getline(f, line)) {
+        size_t pos = line.find_first_not_of(" \t");
+        if (pos == std::string::npos) continue;
+        std::string_view t = std::string_view(line).substr(pos);
+        std::string_view key;
+        size_t after_key = next_quoted(t, 0, key);
+        if (t[0] == '{' && key == "monster") {
+            std::string_view id;
+            if (next_quoted(t, after_key, id) == std::string_view::npos) continue;
+            RawEntry entry;
+            entry.monster = table.strings().intern(id);
+            entry.weight = number_after(t, "\"weight\"", number_after(t, "\"freq\"", 100));
+            size_t pack = t.find("\"pack_size\"");
+            size_t bracket = pack == std::string_view::npos ? pack : t.find('[', pack);
+            if (bracket != std::string_view::npos) {
+                // Read as long and checked before narrowing; strtol
+                // saturates on overflow, which the check also catches.
+                long min = std::strtol(t.data() + bracket + 1, nullptr, 10);
+                size_t comma = t.find(',', bracket);
+                long max = comma != std::string_view::npos ? std::strtol(t.data() + comma + 1, nullptr, 10) : min;
+                min = std::max(1L, min);
+                max = std::max(min, max);
+                if (max > kMaxPackSize) {
+                    std::cerr << "Monster group '" << current << "' has an out of range pack_size in '" << t
+                              << "'." << std::endl;
+                    continue;
+                }
+                entry.pack.min = static_cast<int>(min);
+                entry.pack.max = static_cast<int>(max);
+            }
+            entries.push_back(entry);
+        } else if (key == "id") {
+            std::string_view id;
+            if (next_quoted(t, after_key, id) != std::string_view::npos) current = table.strings().intern(id);
+        } else if (t[0] == '{') {
+            current = Id();
+            entries.clear();
+        } else if (t[0] == '}') {
+            if (!current.empty()) finish_group();
+            current = Id();
+            entries.clear();
+        }
+    }
+    table.assign(groups);
+    metrics::counter("monster_groups_loaded_total", "Monster groups loaded from JSON.").add(table.size());
+    return table;
+}
+
+MonsterSpawnStats spawn_monster_group(Map &map, const MonsterGroup &group, Point first, Point last,
+                                      const MonsterSpawnOptions &options, uint64_t turn, uint64_t seed) {
+    PROFILE_SCOPE("spawn.monster_group");
+    MonsterSpawnStats stats;
+    if (group.table.empty() || !(options.packs_per_submap > 0) || first.x > last.x || first.y > last.y) {
+        return stats;
+    }
+    // Background grid over the region plus a margin of one spacing, in
+    // cells of side r / sqrt(2): two centres in one cell would be
+    // closer than r, so each cell holds at most one.
+    const int r = std::max(1, options.min_distance);
+    const int cell = std::max(1, static_cast<int>(r / std::sqrt(2.0)));
+    const int reach = (r + cell - 1) / cell;
+    const int x0 = first.x * kSubmapSize - r;
+    const int y0 = first.y * kSubmapSize - r;
+    const int width = (last.x - first.x + 1) * kSubmapSize + 2 * r;
+    const int height = (last.y - first.y + 1) * kSubmapSize + 2 * r;
+    const int grid_w = (width + cell - 1) / cell;
+    const int grid_h = (height + cell - 1) / cell;
+    std::vector<int32_t> grid(static_cast<size_t>(grid_w) * grid_h, -1);
+    std::vector<Point> centres;
+    auto cell_index = [&](Point p) -> long {
+        int gx = p.x - x0;
+        int gy = p.y - y0;
+        if (gx < 0 || gy < 0 || gx >= width || gy >= height) return -1;
+        return static_cast<long>(gy / cell) * grid_w + gx / cell;
+    };
+    auto insert = [&](Point p) {
+        long c = cell_index(p);
+        if (c < 0) return;
+        grid[c] = static_cast<int32_t>(centres.size());
+        centres.push_back(p);
+    };
+    auto clear_of_others = [&](Point p) {
+        int cx = (p.x - x0) / cell;
+        int cy = (p.y - y0) / cell;
+        for (int y = std::max(0, cy - reach); y <= std::min(grid_h - 1, cy + reach); ++y) {
+            for (int x = std::max(0, cx - reach); x <= std::min(grid_w - 1, cx + reach); ++x) {
+                int32_t i = grid[static_cast<size_t>(y) * grid_w + x];
+                if (i < 0) continue;
+                int dx = centres[i].x - p.x;
+                int dy = centres[i].y - p.y;
+                if (dx * dx + dy * dy < r * r) return false;
+            }
+        }
+        return true;
+    };
+    // Monsters already on or around the region keep new packs away.
+    // Members of one pack may share a cell; keeping the last of them
+    // is enough, as they stand within a tile of each other.
+    for (int y = first.y - 1; y <= last.y + 1; ++y) {
+        for (int x = first.x - 1; x <= last.x + 1; ++x) {
+            const Submap *sm = map.find(Point{x, y});
+            if (!sm) continue;
+            for (MonsterHandle h : sm->monsters()) {
+                if (const MonsterInstance *m = monster_pool().get(h)) insert(m->pos);
+            }
+        }
+    }
+
+    double whole = std::floor(options.packs_per_submap);
+    double fraction = options.packs_per_submap - whole;
+    for (int y = first.y; y <= last.y; ++y) {
+        for (int x = first.x; x <= last.x; ++x) {
+            Submap &sm = map.submap(Point{x, y});
+            if (sm.monsters_spawned()) continue;
+            Rng rng(Rng::stream_seed(seed ^ kMonsterStream, x, y));
+            int packs = static_cast<int>(whole) + (rng.uniform() < fraction ? 1 : 0);
+            const int left = x * kSubmapSize;
+            const int top = y * kSubmapSize;
+            for (int p = 0; p < packs; ++p) {
+                for (int attempt = 0; attempt < options.attempts; ++attempt) {
+                    Point centre{left + static_cast<int>(rng.below(kSubmapSize)),
+                                 top + static_cast<int>(rng.below(kSubmapSize))};
+                    if (!clear_of_others(centre)) continue;
+                    insert(centre);
+                    uint32_t entry = group.sample(rng);
+                    const PackSize &size = group.packs[entry];
+                    int members = size.min + static_cast<int>(rng.below(static_cast<uint32_t>(size.max - size.min + 1)));
+                    for (int m = 0; m < members; ++m) {
+                        Point at = centre;
+                        if (m > 0) {
+                            at.x = std::clamp(centre.x + static_cast<int>(rng.below(3)) - 1, left, left + kSubmapSize - 1);
+                            at.y = std::clamp(centre.y + static_cast<int>(rng.below(3)) - 1, top, top + kSubmapSize - 1);
+                        }
+                        sm.add_monster(spawn_monster(*group.monsters[entry], at, turn));
+                    }
+                    stats.monsters += members;
+                    ++stats.packs;
+                    break;
+                }
+            }
+            sm.set_monsters_spawned();
+            ++stats.submaps;
+        }
+    }
+    metrics::counter("monsters_spawned_total", "Monster instances created by monster group spawns.")
+        .add(stats.monsters);
+    return stats;
+}
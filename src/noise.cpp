@@ -0,0 +1,291 @@
+/*
+ * Gradient noise kernels declared in noise.h.
+ *
+ * The scalar, SSE2 and AVX2 kernels below must stay in lockstep: the
+ * same operations on the same values in the same order, written out
+ * once per path. Per-octave values that do not depend on x are worked
+ * out once per row, in scalar code shared by all paths.
+ */
+
+#include "noise.h"
+
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SURVIVAL_NOISE_X86 1
+#include <immintrin.h>
+#define SURVIVAL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace {
+
+constexpr uint32_t kPrimeX = 0x8da6b343u;
+constexpr uint32_t kPrimeY = 0xd8163841u;
+constexpr uint32_t kMix1 = 0x2c1b3c6du;
+constexpr uint32_t kMix2 = 0x297a2d39u;
+constexpr uint32_t kOctaveSeed = 0x9e3779b9u;
+constexpr int kMaxOctaves = 16;
+
+// Path every build for this target can take without asking the CPU.
+#if defined(SURVIVAL_NOISE_X86) && defined(__SSE2__)
+constexpr SimdPath kBaseline = SimdPath::sse2;
+#else
+constexpr SimdPath kBaseline = SimdPath::scalar;
+#endif
+
+/** Values of one octave that are the same for a whole row. */
+struct Octave {
+    float frequency;
+    float amplitude;
+    uint32_t seed;
+    // Hash terms of the rows of lattice points above and below.
+    uint32_t hy0;
+    uint32_t hy1;
+    // Offsets from those rows, and the fade of the first.
+    float ty0;
+    float ty1;
+    float v;
+};
+
+/** floor(), the way the SIMD kernels compute it: truncate, then step down if that rounded up. */
+inline int32_t floor_to_int(float x) {
+    int32_t i = static_cast<int32_t>(x);
+    return static_cast<float>(i) > x ? i - 1 : i;
+}
+
+inline uint32_t mix(uint32_t h) {
+    h ^= h >> 15;
+    h *= kMix1;
+    h ^= h >> 12;
+    h *= kMix2;
+    h ^= h >> 15;
+    return h;
+}
+
+inline float fade(float t) {
+    return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+inline float lerp(float a, float b, float t) {
+    return a + t * (b - a);
+}
+
+/** Dot product with the diagonal gradient picked by the low two bits of `h`. */
+inline float grad(uint32_t h, float dx, float dy) {
+    return ((h & 1) ? -dx : dx) + ((h & 2) ? -dy : dy);
+}
+
+int prepare(const NoiseParams &params, int y, Octave *octaves) {
+    int count = std::clamp(params.octaves, 1, kMaxOctaves);
+    float frequency = params.frequency;
+    float amplitude = 1.0f;
+    for (int o = 0; o < count; ++o) {
+        Octave &oct = octaves[o];
+        oct.frequency = frequency;
+        oct.amplitude = amplitude;
+        oct.seed = params.seed + static_cast<uint32_t>(o) * kOctaveSeed;
+        float fy = static_cast<float>(y) * frequency;
+        int32_t iy = floor_to_int(fy);
+        oct.hy0 = static_cast<uint32_t>(iy) * kPrimeY;
+        oct.hy1 = (static_cast<uint32_t>(iy) + 1) * kPrimeY;
+        oct.ty0 = fy - static_cast<float>(iy);
+        oct.ty1 = oct.ty0 - 1.0f;
+        oct.v = fade(oct.ty0);
+        frequency *= params.lacunarity;
+        amplitude *= params.gain;
+    }
+    return count;
+}
+
+void row_scalar(const Octave *octaves, int count, int x0, int from, int to, float *out) {
+    for (int i = from; i < to; ++i) {
+        float xf = static_cast<float>(x0 + i);
+        float sum = 0.0f;
+        for (int o = 0; o < count; ++o) {
+            const Octave &oct = octaves[o];
+            float x = xf * oct.frequency;
+            int32_t ix = floor_to_int(x);
+            float tx0 = x - static_cast<float>(ix);
+            float tx1 = tx0 - 1.0f;
+            uint32_t hx0 = static_cast<uint32_t>(ix) * kPrimeX;
+            uint32_t hx1 = (static_cast<uint32_t>(ix) + 1) * kPrimeX;
+            float n00 = grad(mix(hx0 ^ oct.hy0 ^ oct.seed), tx0, oct.ty0);
+            float n10 = grad(mix(hx1 ^ oct.hy0 ^ oct.seed), tx1, oct.ty0);
+            float n01 = grad(mix(hx0 ^ oct.hy1 ^ oct.seed), tx0, oct.ty1);
+            float n11 = grad(mix(hx1 ^ oct.hy1 ^ oct.seed), tx1, oct.ty1);
+            float u = fade(tx0);
+            sum = sum + oct.amplitude * lerp(lerp(n00, n10, u), lerp(n01, n11, u), oct.v);
+        }
+        out[i] = sum;
+    }
+}
+
+#if defined(SURVIVAL_NOISE_X86) && defined(__SSE2__)
+
+/** 32-bit multiply keeping the low halves; SSE2 only has the widening one. */
+inline __m128i mullo_sse2(__m128i a, __m128i b) {
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+inline __m128i mix_sse2(__m128i h) {
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+    h = mullo_sse2(h, _mm_set1_epi32(static_cast<int>(kMix1)));
+    h = _mm_xor_si128(h, _mm_srli_epi32(h, 12));
+    h = mullo_sse2(h, _mm_set1_epi32(static_cast<int>(kMix2)));
+    return _mm_xor_si128(h, _mm_srli_epi32(h, 15));
+}
+
+inline __m128 fade_sse2(__m128 t) {
+    __m128 t3 = _mm_mul_ps(_mm_mul_ps(t, t), t);
+    __m128 inner = _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f));
+    return _mm_mul_ps(t3, _mm_add_ps(_mm_mul_ps(t, inner), _mm_set1_ps(10.0f)));
+}
+
+inline __m128 lerp_sse2(__m128 a, __m128 b, __m128 t) {
+    return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+}
+
+inline __m128 grad_sse2(__m128i h, __m128 dx, __m128 dy) {
+    // Move bit 0 and bit 1 of the hash into the sign bits.
+    __m128 sx = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(1)), 31));
+    __m128 sy = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(2)), 30));
+    return _mm_add_ps(_mm_xor_ps(dx, sx), _mm_xor_ps(dy, sy));
+}
+
+int row_sse2(const Octave *octaves, int count, int x0, int n, float *out) {
+    const __m128i prime_x = _mm_set1_epi32(static_cast<int>(kPrimeX));
+    const __m128i one = _mm_set1_epi32(1);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 xf = _mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32(x0 + i), _mm_setr_epi32(0, 1, 2, 3)));
+        __m128 sum = _mm_setzero_ps();
+        for (int o = 0; o < count; ++o) {
+            const Octave &oct = octaves[o];
+            __m128 x = _mm_mul_ps(xf, _mm_set1_ps(oct.frequency));
+            __m128i ix = _mm_cvttps_epi32(x);
+            // Where truncation rounded up, the compare mask is -1.
+            ix = _mm_add_epi32(ix, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(ix), x)));
+            __m128 tx0 = _mm_sub_ps(x, _mm_cvtepi32_ps(ix));
+            __m128 tx1 = _mm_sub_ps(tx0, _mm_set1_ps(1.0f));
+            __m128i hx0 = mullo_sse2(ix, prime_x);
+            __m128i hx1 = mullo_sse2(_mm_add_epi32(ix, one), prime_x);
+            __m128i h0 = _mm_set1_epi32(static_cast<int>(oct.hy0 ^ oct.seed));
+            __m128i h1 = _mm_set1_epi32(static_cast<int>(oct.hy1 ^ oct.seed));
+            __m128 ty0 = _mm_set1_ps(oct.ty0);
+            __m128 ty1 = _mm_set1_ps(oct.ty1);
+            __m128 n00 = grad_sse2(mix_sse2(_mm_xor_si128(hx0, h0)), tx0, ty0);
+            __m128 n10 = grad_sse2(mix_sse2(_mm_xor_si128(hx1, h0)), tx1, ty0);
+            __m128 n01 = grad_sse2(mix_sse2(_mm_xor_si128(hx0, h1)), tx0, ty1);
+            __m128 n11 = grad_sse2(mix_sse2(_mm_xor_si128(hx1, h1)), tx1, ty1);
+            __m128 u = fade_sse2(tx0);
+            __m128 value = lerp_sse2(lerp_sse2(n00, n10, u), lerp_sse2(n01, n11, u), _mm_set1_ps(oct.v));
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(oct.amplitude), value));
+        }
+        _mm_storeu_ps(out + i, sum);
+    }
+    return i;
+}
+
+#endif
+
+#if defined(SURVIVAL_NOISE_X86)
+
+SURVIVAL_TARGET_AVX2 inline __m256i mix_avx2(__m256i h) {
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(static_cast<int>(kMix1)));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 12));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(static_cast<int>(kMix2)));
+    return _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+}
+
+SURVIVAL_TARGET_AVX2 inline __m256 fade_avx2(__m256 t) {
+    __m256 t3 = _mm256_mul_ps(_mm256_mul_ps(t, t), t);
+    __m256 inner = _mm256_sub_ps(_mm256_mul_ps(t, _mm256_set1_ps(6.0f)), _mm256_set1_ps(15.0f));
+    return _mm256_mul_ps(t3, _mm256_add_ps(_mm256_mul_ps(t, inner), _mm256_set1_ps(10.0f)));
+}
+
+SURVIVAL_TARGET_AVX2 inline __m256 lerp_avx2(__m256 a, __m256 b, __m256 t) {
+    return _mm256_add_ps(a, _mm256_mul_ps(t, _mm256_sub_ps(b, a)));
+}
+
+SURVIVAL_TARGET_AVX2 inline __m256 grad_avx2(__m256i h, __m256 dx, __m256 dy) {
+    __m256 sx = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(1)), 31));
+    __m256 sy = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(2)), 30));
+    return _mm256_add_ps(_mm256_xor_ps(dx, sx), _mm256_xor_ps(dy, sy));
+}
+
+SURVIVAL_TARGET_AVX2 int row_avx2(const Octave *octaves, int count, int x0, int n, float *out) {
+    const __m256i prime_x = _mm256_set1_epi32(static_cast<int>(kPrimeX));
+    const __m256i one = _mm256_set1_epi32(1);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 xf = _mm256_cvtepi32_ps(
+            _mm256_add_epi32(_mm256_set1_epi32(x0 + i), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+        __m256 sum = _mm256_setzero_ps();
+        for (int o = 0; o < count; ++o) {
+            const Octave &oct = octaves[o];
+            __m256 x = _mm256_mul_ps(xf, _mm256_set1_ps(oct.frequency));
+            __m256i ix = _mm256_cvttps_epi32(x);
+            ix = _mm256_add_epi32(ix, _mm256_castps_si256(_mm256_cmp_ps(_mm256_cvtepi32_ps(ix), x, _CMP_GT_OQ)));
+            __m256 tx0 = _mm256_sub_ps(x, _mm256_cvtepi32_ps(ix));
+            __m256 tx1 = _mm256_sub_ps(tx0, _mm256_set1_ps(1.0f));
+            __m256i hx0 = _mm256_mullo_epi32(ix, prime_x);
+            __m256i hx1 = _mm256_mullo_epi32(_mm256_add_epi32(ix, one), prime_x);
+            __m256i h0 = _mm256_set1_epi32(static_cast<int>(oct.hy0 ^ oct.seed));
+            __m256i h1 = _mm256_set1_epi32(static_cast<int>(oct.hy1 ^ oct.seed));
+            __m256 ty0 = _mm256_set1_ps(oct.ty0);
+            __m256 ty1 = _mm256_set1_ps(oct.ty1);
+            __m256 n00 = grad_avx2(mix_avx2(_mm256_xor_si256(hx0, h0)), tx0, ty0);
+            __m256 n10 = grad_avx2(mix_avx2(_mm256_xor_si256(hx1, h0)), tx1, ty0);
+            __m256 n01 = grad_avx2(mix_avx2(_mm256_xor_si256(hx0, h1)), tx0, ty1);
+            __m256 n11 = grad_avx2(mix_avx2(_mm256_xor_si256(hx1, h1)), tx1, ty1);
+            __m256 u = fade_avx2(tx0);
+            __m256 value = lerp_avx2(lerp_avx2(n00, n10, u), lerp_avx2(n01, n11, u), _mm256_set1_ps(oct.v));
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(oct.amplitude), value));
+        }
+        _mm256_storeu_ps(out + i, sum);
+    }
+    return i;
+}
+
+#endif
+
+} // namespace
+
+SimdPath best_simd_path() {
+#if defined(SURVIVAL_NOISE_X86)
+    static const SimdPath best = __builtin_cpu_supports("avx2") ? SimdPath::avx2 : kBaseline;
+    return best;
+#else
+    return kBaseline;
+#endif
+}
+
+const char *simd_path_name(SimdPath path) {
+    switch (path) {
+    case SimdPath::avx2: return "avx2";
+    case SimdPath::sse2: return "sse2";
+    default: return "scalar";
+    }
+}
+
+void noise_row(const NoiseParams &params, int x0, int y, int count, float *out) {
+    noise_row(params, x0, y, count, out, best_simd_path());
+}
+
+void noise_row(const NoiseParams &params, int x0, int y, int count, float *out, SimdPath path) {
+    Octave octaves[kMaxOctaves];
+    int n = prepare(params, y, octaves);
+    path = std::min(path, best_simd_path());
+    int done = 0;
+#if defined(SURVIVAL_NOISE_X86)
+    if (path == SimdPath::avx2) done = row_avx2(octaves, n, x0, count, out);
+#if defined(__SSE2__)
+    if (path == SimdPath::sse2) done = row_sse2(octaves, n, x0, count, out);
+#endif
+#endif
+    row_scalar(octaves, n, x0, done, count, out);
+}
@@ -0,0 +1,89 @@
+/*
+ * Overmap generation declared in overmap.h.
+ */
+
+#include "overmap.h"
+
+#include "memory_tracker.h"
+#include "profiler.h"
+
+namespace {
+
+// Cities: broad blobs a few dozen tiles across, on the highest ground
+// of a slow noise layer.
+constexpr float kCityFrequency = 1.0f / 40;
+constexpr int kCityOctaves = 3;
+constexpr float kCityThreshold = 0.35f;
+// Forests: finer, patchier noise over what is left.
+constexpr float kForestFrequency = 1.0f / 12;
+constexpr int kForestOctaves = 4;
+constexpr float kForestThreshold = 0.1f;
+// Keeps the two layers of one world seed apart.
+constexpr uint32_t kForestSeed = 0x5bd1e995u;
+
+} // namespace
+
+const char *terrain_name(OvermapTerrain terrain) {
+    switch (terrain) {
+    case OvermapTerrain::forest: return "forest";
+    case OvermapTerrain::city: return "city";
+    default: return "field";
+    }
+}
+
+char terrain_glyph(OvermapTerrain terrain) {
+    switch (terrain) {
+    case OvermapTerrain::forest: return 'F';
+    case OvermapTerrain::city: return 'C';
+    default: return '.';
+    }
+}
+
+Overmap::Overmap(Point pos, uint32_t seed, SimdPath path) : pos_(pos) {
+    PROFILE_SCOPE("overmap.generate");
+    memory::TagScope tag(memory::Tag::world);
+    NoiseParams city;
+    city.seed = seed;
+    city.frequency = kCityFrequency;
+    city.octaves = kCityOctaves;
+    NoiseParams forest;
+    forest.seed = seed ^ kForestSeed;
+    forest.frequency = kForestFrequency;
+    forest.octaves = kForestOctaves;
+    terrain_.resize(kOvermapTiles);
+    float city_row[kOvermapSize];
+    float forest_row[kOvermapSize];
+    const int x0 = pos.x * kOvermapSize;
+    for (int y = 0; y < kOvermapSize; ++y) {
+        const int gy = pos.y * kOvermapSize + y;
+        noise_row(city, x0, gy, kOvermapSize, city_row, path);
+        noise_row(forest, x0, gy, kOvermapSize, forest_row, path);
+        for (int x = 0; x < kOvermapSize; ++x) {
+            OvermapTerrain t = city_row[x] > kCityThreshold     ? OvermapTerrain::city
+                               : forest_row[x] > kForestThreshold ? OvermapTerrain::forest
+                                                                  : OvermapTerrain::field;
+            terrain_[y * kOvermapSize + x] = t;
+            ++counts_[static_cast<int>(t)];
+        }
+    }
+}
+
+const Overmap &OvermapBuffer::get(Point pos) {
+    std::unique_ptr<Overmap> &slot = overmaps_[key(pos)];
+    if (!slot) {
+        memory::TagScope tag(memory::Tag::world);
+        slot = std::make_unique<Overmap>(pos, seed_);
+    }
+    return *slot;
+}
+
+OvermapTerrain OvermapBuffer::terrain(Point omt) {
+    Point om = overmap_of(omt);
+    return get(om).terrain(omt.x - om.x * kOvermapSize, omt.y - om.y * kOvermapSize);
+}
+
+size_t OvermapBuffer::bytes_reserved() const {
+    size_t bytes = overmaps_.bucket_count() * sizeof(void *);
+    for (const auto &entry : overmaps_) bytes += sizeof(entry) + sizeof(Overmap) + entry.second->bytes_reserved();
+    return bytes;
+}
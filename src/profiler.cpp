@@ -0,0 +1,183 @@
+/*
+ * Implementation of the scoped profiler declared in profiler.h.
+ *
+ * Every thread owns a fixed-size open-addressed table keyed by the scope
+ * name pointer. Only the owning thread writes to its table, so updates
+ * are plain relaxed loads and stores on atomics; the atomics exist only
+ * so that a report taken from another thread reads consistent values.
+ * Tables are owned by a global registry so that samples from threads
+ * that have already exited still show up in the final report.
+ */
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "memory_tracker.h"
+
+namespace profiler {
+
+namespace {
+
+constexpr size_t kTableSize = 256; // must be a power of two
+
+struct Entry {
+    std::atomic<const char *> name{nullptr};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> total_ns{0};
+    std::atomic<uint64_t> min_ns{UINT64_MAX};
+    std::atomic<uint64_t> max_ns{0};
+};
+
+struct ThreadTable {
+    Entry entries[kTableSize];
+    std::atomic<uint64_t> dropped{0};
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadTable>> tables;
+};
+
+Registry &registry() {
+    static Registry instance;
+    return instance;
+}
+
+ThreadTable *register_thread() {
+    memory::TagScope tag(memory::Tag::diagnostics);
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.tables.push_back(std::make_unique<ThreadTable>());
+    return reg.tables.back().get();
+}
+
+ThreadTable &local_table() {
+    thread_local ThreadTable *table = register_thread();
+    return *table;
+}
+
+template <typename T>
+void bump(std::atomic<T> &value, T delta) {
+    value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+} // namespace
+
+void record(const char *name, uint64_t ns) {
+    ThreadTable &table = local_table();
+    size_t slot = (reinterpret_cast<uintptr_t>(name) >> 3) & (kTableSize - 1);
+    for (size_t probe = 0; probe < kTableSize; ++probe) {
+        Entry &e = table.entries[(slot + probe) & (kTableSize - 1)];
+        const char *current = e.name.load(std::memory_order_relaxed);
+        if (current == nullptr) {
+            e.name.store(name, std::memory_order_release);
+            current = name;
+        }
+        if (current != name) {
+            continue;
+        }
+        bump<uint64_t>(e.count, 1);
+        bump<uint64_t>(e.total_ns, ns);
+        if (ns < e.min_ns.load(std::memory_order_relaxed)) {
+            e.min_ns.store(ns, std::memory_order_relaxed);
+        }
+        if (ns > e.max_ns.load(std::memory_order_relaxed)) {
+            e.max_ns.store(ns, std::memory_order_relaxed);
+        }
+        return;
+    }
+    bump<uint64_t>(table.dropped, 1);
+}
+
+void write_report(std::ostream &out) {
+    struct Row {
+        std::string name;
+        uint64_t count = 0;
+        uint64_t total_ns = 0;
+        uint64_t min_ns = UINT64_MAX;
+        uint64_t max_ns = 0;
+    };
+    std::vector<Row> rows;
+    uint64_t dropped = 0;
+    {
+        Registry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (const auto &table : reg.tables) {
+            dropped += table->dropped.load(std::memory_order_relaxed);
+            for (const Entry &e : table->entries) {
+                const char *name = e.name.load(std::memory_order_acquire);
+                uint64_t count = e.count.load(std::memory_order_relaxed);
+                if (name == nullptr || count == 0) {
+                    continue;
+                }
+                // The same literal may have different addresses in different
+                // translation units, so merge rows by content.
+                auto it = std::find_if(rows.begin(), rows.end(), [&](const Row &r) {
+                    return r.name == name;
+                });
+                if (it == rows.end()) {
+                    rows.push_back(Row{name});
+                    it = rows.end() - 1;
+                }
+                it->count += count;
+                it->total_ns += e.total_ns.load(std::memory_order_relaxed);
+                it->min_ns = std::min(it->min_ns, e.min_ns.load(std::memory_order_relaxed));
+                it->max_ns = std::max(it->max_ns, e.max_ns.load(std::memory_order_relaxed));
+            }
+        }
+    }
+    std::sort(rows.begin(), rows.end(), [](const Row &a, const Row &b) {
+        return a.total_ns > b.total_ns;
+    });
+
+    if (rows.empty()) {
+        out << "No profile samples recorded." << std::endl;
+        return;
+    }
+    auto flags = out.flags();
+    auto precision = out.precision();
+    out << std::left << std::setw(28) << "scope" << std::right
+        << std::setw(10) << "calls"
+        << std::setw(14) << "total ms"
+        << std::setw(12) << "mean us"
+        << std::setw(12) << "min us"
+        << std::setw(12) << "max us" << std::endl;
+    out << std::fixed;
+    for (const Row &r : rows) {
+        out << std::left << std::setw(28) << r.name << std::right
+            << std::setw(10) << r.count
+            << std::setw(14) << std::setprecision(3) << r.total_ns / 1e6
+            << std::setw(12) << std::setprecision(2) << (r.total_ns / 1e3) / r.count
+            << std::setw(12) << r.min_ns / 1e3
+            << std::setw(12) << r.max_ns / 1e3 << std::endl;
+    }
+    if (dropped > 0) {
+        out << "(" << dropped << " sample(s) dropped: too many distinct scopes)" << std::endl;
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+void reset() {
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (const auto &table : reg.tables) {
+        table->dropped.store(0, std::memory_order_relaxed);
+        for (Entry &e : table->entries) {
+            e.count.store(0, std::memory_order_relaxed);
+            e.total_ns.store(0, std::memory_order_relaxed);
+            e.min_ns.store(UINT64_MAX, std::memory_order_relaxed);
+            e.max_ns.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+} // namespace profiler
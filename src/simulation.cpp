@@ -0,0 +1,357 @@
+/*
+ * Active-area simulation and dormant submap catch-up for simulation.h.
+ */
+
+#include "simulation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <memory_resource>
+#include <vector>
+
+#include "frame_allocator.h"
+#include "instances.h"
+#include "metrics.h"
+#include "profiler.h"
+#include "rng.h"
+
+namespace {
+
+constexpr uint64_t kTurnStream = 0x7e3a2b1c9d5f4e61ULL;
+constexpr uint64_t kCatchUpStream = 0x1b8c6d2e4f3a5970ULL;
+
+/** Active submaps are swept for items that rotted away once an hour. */
+constexpr uint64_t kSweepInterval = 3600;
+
+/**
+ * Per-axis variance of one step to one of the 8 neighbouring tiles:
+ * -1, 0 and +1 with probabilities 3/8, 2/8 and 3/8.
+ */
+constexpr double kStepVariance = 0.75;
+
+/**
+ * Catch-ups this short, such as those of submaps a level of detail
+ * skips (see lod_interval()), replay the monsters' steps rather than
+ * drawing a normal drift: it is exact, and cheaper than two normals.
+ */
+constexpr uint64_t kReplayTurns = 8;
+
+/** Longest catch-up drift in tiles, far beyond any map in play. */
+constexpr double kMaxDrift = 1 << 20;
+
+constexpr Point kSteps[8] = {{-1, -1}, {0, -1}, {1, -1}, {-1, 0}, {1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+constexpr Point kOrthogonal[4] = {{0, -1}, {-1, 0}, {1, 0}, {0, 1}};
+
+/** Chance per turn that a burning tile raises the smoke on it. */
+constexpr double kSmokeChance = 0.5;
+
+metrics::Counter &caught_up_total() {
+    static metrics::Counter &counter =
+        metrics::counter("submaps_caught_up_total", "Dormant submaps fast-forwarded on entering the active area.");
+    return counter;
+}
+
+metrics::Counter &rotted_away_total() {
+    static metrics::Counter &counter =
+        metrics::counter("items_rotted_away_total", "World items removed after rotting away.");
+    return counter;
+}
+
+metrics::Counter &field_tiles_total() {
+    static metrics::Counter &counter =
+        metrics::counter("field_tiles_processed_total", "Active field tiles spread and decayed.");
+    return counter;
+}
+
+double move_chance(const Monster &type) {
+    return std::clamp(type.speed, 0, 100) / 100.0;
+}
+
+/**
+ * Put monster `h`, listed on `from`, on tile `to`. A tile in a submap
+ * that does not exist is brought back to the nearest tile of `from`.
+ * Returns true if the monster was moved to another submap's list.
+ */
+bool move_monster(Map &map, Submap &from, MonsterHandle h, MonsterInstance &m, Point to) {
+    Point dest = submap_of(to);
+    if (dest != from.pos()) {
+        if (Submap *other = map.find(dest)) {
+            m.pos = to;
+            from.remove_monster(h);
+            other->add_monster(h);
+            return true;
+        }
+        const int left = from.pos().x * kSubmapSize;
+        const int top = from.pos().y * kSubmapSize;
+        to.x = std::clamp(to.x, left, left + kSubmapSize - 1);
+        to.y = std::clamp(to.y, top, top + kSubmapSize - 1);
+    }
+    m.pos = to;
+    return false;
+}
+
+/** Remove and destroy the items on `submap` that have rotted away by `now`. */
+size_t remove_rotted(Submap &submap, uint64_t now) {
+    return submap.remove_items_if([now](ItemHandle h) {
+        const ItemInstance *item = item_pool().get(h);
+        if (item && rot(*item, now) < kRotAway) return false;
+        if (item) item_pool().destroy(h);
+        return true;
+    });
+}
+
+/** Field that spread onto a tile of a neighbouring submap. */
+struct Spill {
+    Submap *submap;
+    int tile;
+    FieldType type;
+};
+
+/**
+ * One turn of spread and decay for the fields on `submap`, over the
+ * tiles that were active when the turn began; tiles that catch or fill
+ * during the turn are first processed on the next. Fields that spread
+ * onto neighbouring submaps are held back until the loop is done, then
+ * each neighbour is caught up to the turn before `turn` and receives
+ * them, so that they do not decay over turns before they existed.
+ */
+void update_fields(Map &map, Submap &submap, uint64_t turn, uint64_t seed, Rng &rng, TurnStats &stats) {
+    FieldLayer &layer = *submap.fields();
+    const Point origin{submap.pos().x * kSubmapSize, submap.pos().y * kSubmapSize};
+    std::pmr::vector<Spill> spills(frame::resource());
+    // Spread from tile `tile` by `d` onto the tile beside it, which may
+    // lie on a neighbouring submap; lost off the edge of the map.
+    auto spread = [&](int tile, Point d, FieldType type) {
+        const int x = tile % kSubmapSize + d.x;
+        const int y = tile / kSubmapSize + d.y;
+        if (x >= 0 && x < kSubmapSize && y >= 0 && y < kSubmapSize) {
+            if (type == FieldType::fire) {
+                layer.ignite(y * kSubmapSize + x, 1);
+            } else {
+                layer.add(y * kSubmapSize + x, type, 1);
+            }
+            return;
+        }
+        Point at{origin.x + x, origin.y + y};
+        Submap *other = map.find(submap_of(at));
+        if (!other) return;
+        int to = (at.y - other->pos().y * kSubmapSize) * kSubmapSize + (at.x - other->pos().x * kSubmapSize);
+        spills.push_back(Spill{other, to, type});
+    };
+    const size_t count = layer.active().size();
+    for (size_t k = 0; k < count; ++k) {
+        // Adding fields may grow the active list; index it afresh.
+        const int tile = layer.active()[k];
+        if (int fire = layer.intensity(tile, FieldType::fire)) {
+            double chance = field_info(FieldType::fire).spread * fire / FieldLayer::kMaxIntensity;
+            for (Point d : kOrthogonal) {
+                if (rng.uniform() < chance) spread(tile, d, FieldType::fire);
+            }
+            if (rng.uniform() < kSmokeChance) layer.add(tile, FieldType::smoke, 1);
+        }
+        for (FieldType type : {FieldType::smoke, FieldType::toxic_gas}) {
+            if (layer.intensity(tile, type) == 0 || rng.uniform() >= field_info(type).spread) continue;
+            spread(tile, kOrthogonal[rng.below(4)], type);
+            layer.remove(tile, type, 1);
+        }
+        for (int t = 0; t < kFieldTypes; ++t) {
+            FieldType type = static_cast<FieldType>(t);
+            if (layer.intensity(tile, type) > 0 && rng.uniform() < field_info(type).decay) layer.remove(tile, type, 1);
+        }
+    }
+    layer.compact();
+    stats.field_tiles += count;
+    for (const Spill &spill : spills) {
+        // A neighbour simulated this turn or due later in it is already
+        // up to date, and this returns at once.
+        TurnStats dormant = catch_up(map, *spill.submap, turn - 1, seed);
+        stats.caught_up += dormant.caught_up;
+        stats.items_removed += dormant.items_removed;
+        if (spill.type == FieldType::fire) {
+            spill.submap->field_layer().ignite(spill.tile, 1);
+        } else {
+            spill.submap->field_layer().add(spill.tile, spill.type, 1);
+        }
+    }
+}
+
+/**
+ * Decay the fields on `layer` over `turns` turns in one step. Each
+ * intensity level lasts a geometric number of turns with the type's
+ * decay chance; the levels whose time runs out are removed.
+ */
+void decay_fields(FieldLayer &layer, uint64_t turns, Rng &rng) {
+    for (uint16_t tile : layer.active()) {
+        for (int t = 0; t < kFieldTypes; ++t) {
+            FieldType type = static_cast<FieldType>(t);
+            int levels = layer.intensity(tile, type);
+            if (levels == 0) continue;
+            double log_stay = std::log1p(-field_info(type).decay);
+            double elapsed = 0;
+            int lost = 0;
+            while (lost < levels) {
+                elapsed += 1 + std::floor(std::log1p(-rng.uniform()) / log_stay);
+                if (elapsed > static_cast<double>(turns)) break;
+                ++lost;
+            }
+            layer.remove(tile, type, lost);
+        }
+    }
+    layer.compact();
+}
+
+} // namespace
+
+TurnStats catch_up(Map &map, Submap &submap, uint64_t now, uint64_t seed) {
+    TurnStats stats;
+    if (submap.last_update() >= now) return stats;
+    stats.submaps = 1;
+    stats.caught_up = 1;
+    // Items rot away at the hourly sweeps, as in the active area, so
+    // short catch-ups (a level of detail skipping a few turns) leave
+    // them be.
+    if (now / kSweepInterval != submap.last_update() / kSweepInterval) stats.items_removed = remove_rotted(submap, now);
+    FieldLayer *fields = submap.fields();
+    if (submap.monsters().empty() && (!fields || fields->empty())) {
+        submap.set_last_update(now);
+        return stats;
+    }
+    Rng rng(Rng::stream_seed(seed ^ kCatchUpStream ^ now, submap.pos().x, submap.pos().y));
+    if (fields && !fields->empty()) {
+        decay_fields(*fields, now - submap.last_update(), rng);
+    }
+    for (size_t i = 0; i < submap.monsters().size();) {
+        MonsterHandle h = submap.monsters()[i];
+        MonsterInstance *m = monster_pool().get(h);
+        if (!m) {
+            submap.remove_monster(h);
+            continue;
+        }
+        if (m->updated < now) {
+            const uint64_t elapsed = now - m->updated;
+            const double chance = move_chance(*m->type);
+            Point to = m->pos;
+            if (elapsed <= kReplayTurns) {
+                for (uint64_t t = 0; t < elapsed; ++t) {
+                    if (rng.uniform() < chance) {
+                        Point step = kSteps[rng.below(8)];
+                        to.x += step.x;
+                        to.y += step.y;
+                    }
+                }
+            } else {
+                double sigma = std::sqrt(kStepVariance * chance * static_cast<double>(elapsed));
+                auto drift = [&]() {
+                    return static_cast<int>(std::clamp(std::round(sigma * rng.normal()), -kMaxDrift, kMaxDrift));
+                };
+                to.x += drift();
+                to.y += drift();
+            }
+            m->updated = now;
+            ++stats.monsters;
+            if (move_monster(map, submap, h, *m, to)) continue;
+        }
+        ++i;
+    }
+    submap.set_last_update(now);
+    return stats;
+}
+
+TurnStats simulate_turn(Map &map, Point center, int radius, uint64_t turn, uint64_t seed, int lod) {
+    PROFILE_SCOPE("sim.turn");
+    TurnStats stats;
+    for (int y = center.y - radius; y <= center.y + radius; ++y) {
+        for (int x = center.x - radius; x <= center.x + radius; ++x) {
+            if (lod > 0) {
+                // Intervals are powers of two; the phase staggers
+                // neighbouring submaps. Deciding before the lookup
+                // saves that too.
+                int ring = std::max(std::abs(x - center.x), std::abs(y - center.y));
+                uint64_t interval = lod_interval(ring, radius, lod);
+                uint64_t phase = static_cast<uint64_t>(x) * 3 + static_cast<uint64_t>(y) * 5;
+                if (((turn + phase) & (interval - 1)) != 0) {
+                    ++stats.deferred;
+                    continue;
+                }
+            }
+            Submap *sm = map.find(Point{x, y});
+            if (!sm || sm->last_update() >= turn) continue;
+            if (sm->last_update() + 1 < turn) {
+                TurnStats dormant = catch_up(map, *sm, turn - 1, seed);
+                stats.caught_up += dormant.caught_up;
+                stats.items_removed += dormant.items_removed;
+            }
+            Rng rng(Rng::stream_seed(seed ^ kTurnStream ^ turn, x, y));
+            for (size_t i = 0; i < sm->monsters().size();) {
+                MonsterHandle h = sm->monsters()[i];
+                MonsterInstance *m = monster_pool().get(h);
+                if (!m) {
+                    sm->remove_monster(h);
+                    continue;
+                }
+                // Monsters that walked in from a submap simulated
+                // earlier this turn have already moved.
+                if (m->updated < turn) {
+                    m->updated = turn;
+                    ++stats.monsters;
+                    if (rng.uniform() < move_chance(*m->type)) {
+                        Point step = kSteps[rng.below(8)];
+                        if (move_monster(map, *sm, h, *m, Point{m->pos.x + step.x, m->pos.y + step.y})) continue;
+                    }
+                }
+                ++i;
+            }
+            if (FieldLayer *fields = sm->fields(); fields && !fields->empty()) {
+                update_fields(map, *sm, turn, seed, rng, stats);
+            }
+            if (turn % kSweepInterval == 0) stats.items_removed += remove_rotted(*sm, turn);
+            sm->set_last_update(turn);
+            ++stats.submaps;
+        }
+    }
+    if (stats.caught_up) caught_up_total().add(stats.caught_up);
+    if (stats.items_removed) rotted_away_total().add(stats.items_removed);
+    if (stats.field_tiles) field_tiles_total().add(stats.field_tiles);
+    return stats;
+}
+
+int nearest_monster(const Map &map, Point tile, int radius) {
+    Point center = submap_of(tile);
+    int nearest = -1;
+    for (int y = center.y - radius; y <= center.y + radius; ++y) {
+        for (int x = center.x - radius; x <= center.x + radius; ++x) {
+            const Submap *sm = map.find(Point{x, y});
+            if (!sm) continue;
+            for (MonsterHandle h : sm->monsters()) {
+                const MonsterInstance *m = monster_pool().get(h);
+                if (!m) continue;
+                int d = std::max(std::abs(m->pos.x - tile.x), std::abs(m->pos.y - tile.y));
+                if (nearest < 0 || d < nearest) nearest = d;
+            }
+        }
+    }
+    return nearest;
+}
+
+bool area_is_quiet(const Map &map, Point center, int radius) {
+    for (int y = center.y - radius; y <= center.y + radius; ++y) {
+        for (int x = center.x - radius; x <= center.x + radius; ++x) {
+            const Submap *sm = map.find(Point{x, y});
+            if (!sm) continue;
+            if (!sm->monsters().empty() || (sm->fields() && !sm->fields()->empty())) return false;
+        }
+    }
+    return true;
+}
+
+void place_field(Map &map, Point tile, FieldType type, int intensity, uint64_t now, uint64_t seed) {
+    Submap &sm = map.submap(submap_of(tile));
+    catch_up(map, sm, now, seed);
+    int local = (tile.y - sm.pos().y * kSubmapSize) * kSubmapSize + (tile.x - sm.pos().x * kSubmapSize);
+    if (type == FieldType::fire) {
+        sm.field_layer().ignite(local, intensity);
+    } else {
+        sm.field_layer().add(local, type, intensity);
+    }
+}
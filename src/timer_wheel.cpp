@@ -0,0 +1,101 @@
+/*
+ * Implementation of the timing wheel declared in timer_wheel.h.
+ */
+
+#include "timer_wheel.h"
+
+#include <algorithm>
+
+#include "memory_tracker.h"
+
+TimerId TimerWheel::schedule(uint64_t turn, TimerEvent event) {
+    uint64_t latest = now_ + (uint64_t(1) << (kLevels * kSlotBits)) - 1;
+    uint64_t deadline = std::min(std::max(turn, now_ + 1), latest);
+    uint32_t n;
+    if (!free_.empty()) {
+        n = free_.back();
+        free_.pop_back();
+    } else {
+        memory::TagScope tag(memory::Tag::world);
+        n = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    Node &node = nodes_[n];
+    node.deadline = deadline;
+    node.event = event;
+    link(n);
+    ++size_;
+    return TimerId{n, node.generation};
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    if (!pending(id)) return false;
+    unlink(id.index);
+    release(id.index);
+    return true;
+}
+
+void TimerWheel::step_to(uint64_t turn) {
+    // With the lowest k wheels empty, nothing can fire before the next
+    // boundary of a block of 256^k turns, where the wheel above next
+    // redistributes; jump straight there (or to `turn`).
+    int empty = 0;
+    while (empty < kLevels && level_count_[empty] == 0) ++empty;
+    uint64_t next = now_ + 1;
+    if (empty == kLevels) {
+        next = turn;
+    } else if (empty > 0) {
+        uint64_t block_mask = (uint64_t(1) << (kSlotBits * empty)) - 1;
+        next = std::min((now_ | block_mask) + 1, turn);
+    }
+    now_ = next;
+    for (int level = kLevels - 1; level > 0; --level) {
+        if ((now_ & ((uint64_t(1) << (kSlotBits * level)) - 1)) == 0) cascade(level);
+    }
+}
+
+void TimerWheel::cascade(int level) {
+    uint32_t head = level * kSlots + static_cast<uint32_t>((now_ >> (kSlotBits * level)) & kSlotMask);
+    while (heads_[head] != kNone) {
+        uint32_t n = heads_[head];
+        unlink(n);
+        link(n);
+    }
+}
+
+void TimerWheel::link(uint32_t n) {
+    Node &node = nodes_[n];
+    // The lowest wheel whose current block contains the deadline.
+    int level = 0;
+    while (level < kLevels - 1 &&
+           (node.deadline >> (kSlotBits * (level + 1))) != (now_ >> (kSlotBits * (level + 1)))) {
+        ++level;
+    }
+    uint32_t head = level * kSlots + static_cast<uint32_t>((node.deadline >> (kSlotBits * level)) & kSlotMask);
+    node.slot = head;
+    node.prev = kNone;
+    node.next = heads_[head];
+    if (node.next != kNone) nodes_[node.next].prev = n;
+    heads_[head] = n;
+    ++level_count_[level];
+}
+
+void TimerWheel::unlink(uint32_t n) {
+    Node &node = nodes_[n];
+    if (node.prev != kNone) {
+        nodes_[node.prev].next = node.next;
+    } else {
+        heads_[node.slot] = node.next;
+    }
+    if (node.next != kNone) nodes_[node.next].prev = node.prev;
+    node.prev = node.next = kNone;
+    --level_count_[node.slot / kSlots];
+}
+
+void TimerWheel::release(uint32_t n) {
+    Node &node = nodes_[n];
+    node.slot = kFree;
+    ++node.generation;
+    free_.push_back(n);
+    --size_;
+}
@@ -0,0 +1,167 @@
+/*
+ * Implementation of the event tracer declared in trace.h.
+ *
+ * Each thread lazily registers a ring buffer with the global registry
+ * on its first span. The owning thread is the only writer: it fills the
+ * slot and then publishes it by advancing `head` with release ordering,
+ * so the exporter can read up to an acquired head without locking the
+ * hot path.
+ */
+
+#include "trace.h"
+
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "memory_tracker.h"
+
+namespace trace {
+
+namespace detail {
+std::atomic<bool> enabled{false};
+}
+
+namespace {
+
+struct Span {
+    const char *name;
+    int64_t begin_ns;
+    int64_t end_ns;
+};
+
+struct ThreadRing {
+    uint32_t tid = 0;
+    std::string thread_name;
+    // Allocated on the first span so threads that never trace (or only
+    // name themselves) cost nothing.
+    std::vector<Span> spans;
+    std::atomic<uint64_t> head{0};
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+};
+
+Registry &registry() {
+    static Registry instance;
+    return instance;
+}
+
+ThreadRing *register_thread() {
+    memory::TagScope tag(memory::Tag::diagnostics);
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    auto ring = std::make_unique<ThreadRing>();
+    ring->tid = static_cast<uint32_t>(reg.rings.size() + 1);
+    ring->thread_name = "thread " + std::to_string(ring->tid);
+    reg.rings.push_back(std::move(ring));
+    return reg.rings.back().get();
+}
+
+ThreadRing &local_ring() {
+    thread_local ThreadRing *ring = register_thread();
+    return *ring;
+}
+
+void write_escaped(std::ostream &out, const std::string &s) {
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out << ' ';
+        } else {
+            out << c;
+        }
+    }
+}
+
+} // namespace
+
+void start() {
+    Registry &reg = registry();
+    {
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (const auto &ring : reg.rings) {
+            ring->head.store(0, std::memory_order_relaxed);
+        }
+    }
+    detail::enabled.store(true, std::memory_order_release);
+}
+
+void stop() {
+    detail::enabled.store(false, std::memory_order_release);
+}
+
+void record_span(const char *name,
+                 std::chrono::steady_clock::time_point begin,
+                 std::chrono::steady_clock::time_point end) {
+    ThreadRing &ring = local_ring();
+    if (ring.spans.empty()) {
+        memory::TagScope tag(memory::Tag::diagnostics);
+        ring.spans.resize(kRingCapacity);
+    }
+    const auto epoch = registry().epoch;
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    Span &span = ring.spans[head % kRingCapacity];
+    span.name = name;
+    span.begin_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(begin - epoch).count();
+    span.end_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - epoch).count();
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+void set_thread_name(const std::string &name) {
+    ThreadRing &ring = local_ring();
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    ring.thread_name = name;
+}
+
+void write_chrome_json(std::ostream &out) {
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    auto flags = out.flags();
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&]() {
+        if (!first) {
+            out << ",\n";
+        }
+        first = false;
+    };
+    for (const auto &ring : reg.rings) {
+        separator();
+        out << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->tid
+            << ",\"name\":\"thread_name\",\"args\":{\"name\":\"";
+        write_escaped(out, ring->thread_name);
+        out << "\"}}";
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t first_index = head > kRingCapacity ? head - kRingCapacity : 0;
+        for (uint64_t i = first_index; i < head; ++i) {
+            const Span &span = ring->spans[i % kRingCapacity];
+            separator();
+            out << "{\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->tid << ",\"name\":\"";
+            write_escaped(out, span.name);
+            out << "\",\"ts\":" << span.begin_ns / 1e3
+                << ",\"dur\":" << (span.end_ns - span.begin_ns) / 1e3 << "}";
+        }
+    }
+    out << "\n]}\n";
+    out.flags(flags);
+}
+
+bool write_chrome_json_file(const std::string &path) {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    write_chrome_json(out);
+    return static_cast<bool>(out);
+}
+
+} // namespace trace
@@ -0,0 +1,90 @@
+/*
+ * Crafting next to an approaching horde: turns pass in batches while
+ * the player works, and a batch must not run past the turn a horde
+ * expands into the active area, or its monsters could walk up to the
+ * player unseen by the interrupt check.
+ */
+
+#include <cstdint>
+#include <iostream>
+
+#include "content.h"
+#include "crafting.h"
+#include "horde.h"
+#include "map.h"
+#include "monster_group.h"
+#include "overmap.h"
+#include "simulation.h"
+
+namespace {
+
+constexpr uint64_t kSeed = 1;
+constexpr size_t kHordes = 3000;
+constexpr int kCraftTurns = 300;
+constexpr uint64_t kWaitTurns = 200;
+
+int failures = 0;
+
+void check(bool ok, const char *what) {
+    if (!ok) {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+} // namespace
+
+int main() {
+    MonsterTable monsters = load_monsters("data/json/monsters.json");
+    MonsterGroupTable groups = load_monster_groups("data/json/monster_groups.json", monsters);
+    const MonsterGroup *group = groups.find(Id("GROUP_EXAMPLE"));
+    if (!group) {
+        std::cerr << "GROUP_EXAMPLE is missing from data/json/monster_groups.json." << std::endl;
+        return 1;
+    }
+
+    Map map;
+    Overmap overmap(Point{0, 0}, kSeed);
+    Hordes hordes;
+    hordes.populate(overmap, *group, kHordes, 20, 80, kSeed);
+    const Point tile{0, 0};
+    const Point center = submap_of(tile);
+    uint64_t now = 0;
+    size_t expanded = 0;
+    // Turns pass as the game passes them; returns the hordes expanded.
+    auto pass = [&](uint64_t turns) {
+        size_t n = 0;
+        for (uint64_t t = 0; t < turns; ++t) {
+            ++now;
+            simulate_turn(map, center, kActiveRadius, now, kSeed);
+            n += hordes.update(map, center, kActiveRadius, now, kSeed).expanded;
+        }
+        return n;
+    };
+    hordes.update(map, center, kActiveRadius, now, kSeed);
+    pass(kWaitTurns);
+
+    Recipe recipe;
+    recipe.time = kCraftTurns;
+    CraftProgress craft{&recipe, 0};
+    size_t batches = 0;
+    bool overran = false;
+    work_on(
+        craft, [&]() { return craft_safe_turns(map, hordes, tile, kActiveRadius, now); },
+        [&](uint64_t turns) {
+            ++batches;
+            // Only the last turn of a batch may bring a horde in; the
+            // next batch is sized with its monsters on the map.
+            size_t before = pass(turns - 1);
+            overran |= before > 0;
+            expanded += before + pass(1);
+        });
+
+    check(expanded > 0, "a horde expands while the player crafts");
+    check(!overran, "no batch of turns runs past a horde expanding");
+    check(batches > 1, "the craft is worked in several batches");
+    if (failures) return 1;
+    std::cout << "Crafted for " << craft.done << " of " << kCraftTurns << " turn(s) in " << batches
+              << " batch(es); " << expanded << " horde(s) expanded." << std::endl;
+    return 0;
+}
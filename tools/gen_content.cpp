@@ -0,0 +1,127 @@
+/*
+ * survival_gen: write a synthetic content set for load and scale testing.
+ *
+ * Usage:
+ *   survival_gen --out=<dir> [--scale=<n>] [--items=<n>] [--monsters=<n>]
+ *                [--recipes=<n>] [--item-groups=<n>] [--monster-groups=<n>]
+ *                [--mods=<n>] [--mod-items=<n>] [--seed=<n>]
+ *
+ * --scale sets the item count and derives the others in roughly the
+ * proportions of the real game (one monster per ten items, one recipe
+ * per two items, one item group per fifty items, one monster group per
+ * two hundred items, mods a tenth of the base set); explicit counts given
+ * after it override the derived values. Counts accept k/M suffixes, so
+ * --scale=10M generates ten million items.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "content_gen.h"
+
+namespace {
+
+/** Parse a count such as "250", "10k" or "10M". Returns false if malformed or too large for size_t. */
+bool parse_count(const std::string &text, size_t &value) {
+    if (text.empty()) {
+        return false;
+    }
+    size_t multiplier = 1;
+    std::string digits = text;
+    char suffix = text.back();
+    if (suffix == 'k' || suffix == 'K') {
+        multiplier = 1000;
+        digits.pop_back();
+    } else if (suffix == 'm' || suffix == 'M') {
+        multiplier = 1000000;
+        digits.pop_back();
+    }
+    // stoull would skip leading whitespace and wrap a minus sign
+    // around, so the text must start with a digit.
+    if (digits.empty() || digits[0] < '0' || digits[0] > '9') {
+        return false;
+    }
+    try {
+        size_t used = 0;
+        unsigned long long n = std::stoull(digits, &used);
+        if (used != digits.size() || n > SIZE_MAX / multiplier) {
+            return false;
+        }
+        value = static_cast<size_t>(n) * multiplier;
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    ContentGenOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string opt = argv[i];
+        auto eq = opt.find('=');
+        std::string key = opt.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : opt.substr(eq + 1);
+        size_t n = 0;
+        bool numeric = key != "--out" && parse_count(value, n);
+        if (key == "--out" && !value.empty()) {
+            options.out_dir = value;
+        } else if (key == "--scale" && numeric) {
+            options.items = n;
+            options.monsters = std::max<size_t>(1, n / 10);
+            options.recipes = std::max<size_t>(1, n / 2);
+            options.item_groups = std::max<size_t>(1, n / 50);
+            options.monster_groups = std::max<size_t>(1, n / 200);
+            options.mod_items = std::max<size_t>(1, n / 10);
+        } else if (key == "--items" && numeric) {
+            options.items = n;
+        } else if (key == "--monsters" && numeric) {
+            options.monsters = n;
+        } else if (key == "--recipes" && numeric) {
+            options.recipes = n;
+        } else if (key == "--item-groups" && numeric) {
+            options.item_groups = n;
+        } else if (key == "--monster-groups" && numeric) {
+            options.monster_groups = n;
+        } else if (key == "--mods" && numeric) {
+            options.mods = n;
+        } else if (key == "--mod-items" && numeric) {
+            options.mod_items = n;
+        } else if (key == "--seed" && numeric) {
+            options.seed = n;
+        } else {
+            std::cerr << "Unknown or invalid option '" << opt << "'." << std::endl;
+            return 1;
+        }
+    }
+    if (options.out_dir.empty()) {
+        std::cerr << "Usage: survival_gen --out=<dir> [--scale=<n>] [--items=<n>] [--monsters=<n>]"
+                  << " [--recipes=<n>] [--item-groups=<n>] [--monster-groups=<n>]"
+                  << " [--mods=<n>] [--mod-items=<n>] [--seed=<n>]" << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    ContentGenResult result;
+    if (!generate_content(options, result)) {
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Generated " << options.items << " item(s), " << options.monsters << " monster(s), "
+              << options.recipes << " recipe(s), " << options.item_groups << " item group(s), "
+              << options.monster_groups << " monster group(s) and "
+              << options.mods << " mod(s) in " << seconds << " s." << std::endl
+              << " - " << result.items_path << std::endl
+              << " - " << result.monsters_path << std::endl
+              << " - " << result.recipes_path << std::endl
+              << " - " << result.item_groups_path << std::endl
+              << " - " << result.monster_groups_path << std::endl;
+    if (options.mods > 0) {
+        std::cout << " - " << result.mods_dir << std::endl;
+    }
+    return 0;
+}